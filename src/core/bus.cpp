@@ -814,7 +814,7 @@ ALWAYS_INLINE static TickCount DoRAMAccess(u32 offset, u32& value)
         {
           g_ram[offset] = Truncate8(value);
           if (m_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithAddress(page_index, offset);
         }
       }
       else if constexpr (size == MemoryAccessSize::HalfWord)
@@ -826,7 +826,7 @@ ALWAYS_INLINE static TickCount DoRAMAccess(u32 offset, u32& value)
         {
           std::memcpy(&g_ram[offset], &new_value, sizeof(u16));
           if (m_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithAddress(page_index, offset);
         }
       }
       else if constexpr (size == MemoryAccessSize::Word)
@@ -837,14 +837,14 @@ ALWAYS_INLINE static TickCount DoRAMAccess(u32 offset, u32& value)
         {
           std::memcpy(&g_ram[offset], &value, sizeof(u32));
           if (m_ram_code_bits[page_index])
-            CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+            CPU::CodeCache::InvalidateBlocksWithAddress(page_index, offset);
         }
       }
     }
     else
     {
       if (m_ram_code_bits[page_index])
-        CPU::CodeCache::InvalidateBlocksWithPageIndex(page_index);
+        CPU::CodeCache::InvalidateBlocksWithAddress(page_index, offset);
 
       if constexpr (size == MemoryAccessSize::Byte)
       {
@@ -4,20 +4,39 @@
 #include "cheats.h"
 #include "bus.h"
 #include "common/assert.h"
+#include "common/bitutils.h"
 #include "common/byte_stream.h"
 #include "common/file_system.h"
 #include "common/log.h"
 #include "common/string.h"
 #include "common/string_util.h"
+#include "common/thirdparty/thread_pool.h"
 #include "controller.h"
 #include "cpu_code_cache.h"
 #include "cpu_core.h"
 #include "host.h"
 #include "system.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
 #include <cctype>
+#include <cstring>
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <type_traits>
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 Log_SetChannel(Cheats);
 static std::array<u32, 256> cht_register; // Used for D7 ,51 & 52 cheat types
 
@@ -259,7 +278,7 @@ bool CheatList::LoadFromPCSXRString(const std::string& str)
 
       // new cheat
       if (current_code.Valid())
-        m_codes.push_back(std::move(current_code));
+        AddCode(std::move(current_code));
 
       current_code = CheatCode();
       if (group.empty())
@@ -308,7 +327,7 @@ bool CheatList::LoadFromPCSXRString(const std::string& str)
     // technically this isn't the place for end of file
     if (!comments.empty())
       current_code.comments += comments;
-    m_codes.push_back(std::move(current_code));
+    AddCode(std::move(current_code));
   }
 
   Log_InfoPrintf("Loaded %zu cheats (PCSXR format)", m_codes.size());
@@ -411,7 +430,7 @@ bool CheatList::LoadFromLibretroString(const std::string& str)
     cc.description = *desc;
     cc.enabled = StringUtil::FromChars<bool>(*enable).value_or(false);
     if (ParseLibretroCheat(&cc, code->c_str()))
-      m_codes.push_back(std::move(cc));
+      AddCode(std::move(cc));
   }
 
   Log_InfoPrintf("Loaded %zu cheats (libretro format)", m_codes.size());
@@ -454,7 +473,7 @@ bool CheatList::LoadFromEPSXeString(const std::string& str)
 
       // new cheat
       if (current_code.Valid())
-        m_codes.push_back(std::move(current_code));
+        AddCode(std::move(current_code));
 
       current_code = CheatCode();
       if (group.empty())
@@ -499,7 +518,7 @@ bool CheatList::LoadFromEPSXeString(const std::string& str)
   }
 
   if (current_code.Valid())
-    m_codes.push_back(std::move(current_code));
+    AddCode(std::move(current_code));
 
   Log_InfoPrintf("Loaded %zu cheats (EPSXe format)", m_codes.size());
   return !m_codes.empty();
@@ -551,20 +570,78 @@ bool CheatList::ParseLibretroCheat(CheatCode* cc, const char* line)
   return !cc->instructions.empty();
 }
 
+struct CheatCode::ConditionCache
+{
+  static constexpr u32 MAX_ENTRIES = 32;
+
+  struct Entry
+  {
+    u32 offset;
+    u32 size;
+    u32 value;
+  };
+
+  std::array<Entry, MAX_ENTRIES> entries;
+  u32 count = 0;
+  u32 next_evict = 0;
+
+  bool Lookup(u32 offset, u32 size, u32* value) const
+  {
+    for (u32 i = 0; i < count; i++)
+    {
+      if (entries[i].offset == offset && entries[i].size == size)
+      {
+        *value = entries[i].value;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  void Insert(u32 offset, u32 size, u32 value)
+  {
+    if (count < MAX_ENTRIES)
+    {
+      entries[count++] = {offset, size, value};
+      return;
+    }
+
+    entries[next_evict] = {offset, size, value};
+    next_evict = (next_evict + 1) % MAX_ENTRIES;
+  }
+
+  void Invalidate(u32 offset, u32 size)
+  {
+    for (u32 i = 0; i < count;)
+    {
+      if (entries[i].offset < (offset + size) && offset < (entries[i].offset + entries[i].size))
+        entries[i] = entries[--count];
+      else
+        i++;
+    }
+  }
+
+  void Clear() { count = 0; }
+};
+
 void CheatList::Apply()
 {
   if (!m_master_enable)
     return;
 
+  // Nothing else runs between codes, so conditions on the same location can share a read until it's written.
+  CheatCode::ConditionCache cache;
   for (const CheatCode& code : m_codes)
   {
     if (code.enabled)
-      code.Apply();
+      code.Apply(cache);
   }
 }
 
 void CheatList::AddCode(CheatCode cc)
 {
+  cc.Compile();
   m_codes.push_back(std::move(cc));
 }
 
@@ -573,6 +650,7 @@ void CheatList::SetCode(u32 index, CheatCode cc)
   if (index > m_codes.size())
     return;
 
+  cc.Compile();
   if (index == m_codes.size())
   {
     m_codes.push_back(std::move(cc));
@@ -750,7 +828,7 @@ bool CheatList::LoadFromPackage(const std::string& serial)
 
         if (current_code.Valid())
         {
-          m_codes.push_back(std::move(current_code));
+          AddCode(std::move(current_code));
           current_code = CheatCode();
         }
 
@@ -789,7 +867,7 @@ bool CheatList::LoadFromPackage(const std::string& serial)
     }
 
     if (current_code.Valid())
-      m_codes.push_back(std::move(current_code));
+      AddCode(std::move(current_code));
 
     Log_InfoPrintf("Loaded %zu codes from package for %s", m_codes.size(), serial.c_str());
     return !m_codes.empty();
@@ -948,6 +1026,7 @@ bool CheatCode::SetInstructionsFromString(const std::string& str)
     return false;
 
   instructions = std::move(new_instructions);
+  Compile();
   return true;
 }
 
@@ -990,7 +1069,271 @@ u32 CheatCode::GetNextNonConditionalInstruction(u32 index) const
   return index;
 }
 
+namespace {
+enum class CompiledOp : u8
+{
+  Nop,
+  Write,
+  BitSet,
+  BitClear,
+  Add,
+  Subtract,
+  CompareEqual,
+  CompareNotEqual,
+  CompareLess,
+  CompareGreater,
+  CompareButtons,
+};
+
+enum CompiledFlags : u8
+{
+  COMPILED_FLAG_SIZE_MASK = 0x03, // log2 of the access size
+  COMPILED_FLAG_DIRECT_RAM = 0x04,
+};
+} // namespace
+
+static bool CompileCheatInstruction(const CheatCode::Instruction& inst, CheatCode::CompiledInstruction* ci)
+{
+  using IC = CheatCode::InstructionCode;
+
+  CompiledOp op;
+  u32 size_shift;
+  u32 address = inst.address;
+  bool direct = true;
+  switch (inst.code)
+  {
+      // clang-format off
+    case IC::Nop: op = CompiledOp::Nop; size_shift = 0; break;
+    case IC::ConstantWrite8: op = CompiledOp::Write; size_shift = 0; break;
+    case IC::ConstantWrite16: op = CompiledOp::Write; size_shift = 1; break;
+    case IC::ExtConstantWrite32: op = CompiledOp::Write; size_shift = 2; break;
+    case IC::ExtConstantBitSet8: op = CompiledOp::BitSet; size_shift = 0; break;
+    case IC::ExtConstantBitSet16: op = CompiledOp::BitSet; size_shift = 1; break;
+    case IC::ExtConstantBitSet32: op = CompiledOp::BitSet; size_shift = 2; break;
+    case IC::ExtConstantBitClear8: op = CompiledOp::BitClear; size_shift = 0; break;
+    case IC::ExtConstantBitClear16: op = CompiledOp::BitClear; size_shift = 1; break;
+    case IC::ExtConstantBitClear32: op = CompiledOp::BitClear; size_shift = 2; break;
+    case IC::Increment8: op = CompiledOp::Add; size_shift = 0; break;
+    case IC::Increment16: op = CompiledOp::Add; size_shift = 1; break;
+    case IC::ExtIncrement32: op = CompiledOp::Add; size_shift = 2; break;
+    case IC::Decrement8: op = CompiledOp::Subtract; size_shift = 0; break;
+    case IC::Decrement16: op = CompiledOp::Subtract; size_shift = 1; break;
+    case IC::ExtDecrement32: op = CompiledOp::Subtract; size_shift = 2; break;
+    case IC::CompareEqual8: op = CompiledOp::CompareEqual; size_shift = 0; break;
+    case IC::CompareEqual16: op = CompiledOp::CompareEqual; size_shift = 1; break;
+    case IC::ExtCompareEqual32: op = CompiledOp::CompareEqual; size_shift = 2; break;
+    case IC::CompareNotEqual8: op = CompiledOp::CompareNotEqual; size_shift = 0; break;
+    case IC::CompareNotEqual16: op = CompiledOp::CompareNotEqual; size_shift = 1; break;
+    case IC::ExtCompareNotEqual32: op = CompiledOp::CompareNotEqual; size_shift = 2; break;
+    case IC::CompareLess8: op = CompiledOp::CompareLess; size_shift = 0; break;
+    case IC::CompareLess16: op = CompiledOp::CompareLess; size_shift = 1; break;
+    case IC::ExtCompareLess32: op = CompiledOp::CompareLess; size_shift = 2; break;
+    case IC::CompareGreater8: op = CompiledOp::CompareGreater; size_shift = 0; break;
+    case IC::CompareGreater16: op = CompiledOp::CompareGreater; size_shift = 1; break;
+    case IC::ExtCompareGreater32: op = CompiledOp::CompareGreater; size_shift = 2; break;
+    case IC::CompareButtons: op = CompiledOp::CompareButtons; size_shift = 1; break;
+      // clang-format on
+
+    case IC::ScratchpadWrite16:
+    case IC::ExtScratchpadWrite32:
+    {
+      op = CompiledOp::Write;
+      size_shift = (inst.code == IC::ScratchpadWrite16) ? 1 : 2;
+      address = CPU::DCACHE_LOCATION | (inst.address & CPU::DCACHE_OFFSET_MASK);
+      direct = false;
+    }
+    break;
+
+    default:
+      return false;
+  }
+
+  // Aligned RAM accesses skip the bus, anything else (mirrors past RAM, misaligned) goes through the safe handlers.
+  const u32 size = 1u << size_shift;
+  direct = direct && (address < Bus::RAM_MIRROR_END) && (address & (size - 1)) == 0;
+
+  ci->address = address;
+  ci->value = (size_shift == 0) ? inst.value8 : ((size_shift == 1) ? inst.value16 : inst.value32);
+  ci->fail_index = 0;
+  ci->op = static_cast<u8>(op);
+  ci->flags = static_cast<u8>(size_shift | (direct ? COMPILED_FLAG_DIRECT_RAM : 0));
+  return true;
+}
+
+void CheatCode::Compile()
+{
+  compiled_instructions.clear();
+
+  const u32 count = static_cast<u32>(instructions.size());
+  if (count > std::numeric_limits<u16>::max())
+    return;
+
+  compiled_instructions.resize(count);
+  for (u32 i = 0; i < count; i++)
+  {
+    const Instruction& inst = instructions[i];
+    CompiledInstruction& ci = compiled_instructions[i];
+    if (!CompileCheatInstruction(inst, &ci))
+    {
+      // multi-instruction and control flow codes are left to the interpreter
+      compiled_instructions.clear();
+      return;
+    }
+
+    if (IsConditionalInstruction(inst.code))
+      ci.fail_index = static_cast<u16>(GetNextNonConditionalInstruction(i));
+  }
+}
+
+template<typename T>
+ALWAYS_INLINE static T ReadCompiled(const CheatCode::CompiledInstruction& ci)
+{
+  if (!(ci.flags & COMPILED_FLAG_DIRECT_RAM))
+    return DoMemoryRead<T>(ci.address);
+
+  T value;
+  std::memcpy(&value, &Bus::g_ram[ci.address & Bus::g_ram_mask], sizeof(value));
+  return value;
+}
+
+template<typename T>
+ALWAYS_INLINE static void WriteCompiled(const CheatCode::CompiledInstruction& ci, T value,
+                                        CheatCode::ConditionCache& cache)
+{
+  if (!(ci.flags & COMPILED_FLAG_DIRECT_RAM))
+  {
+    // could be a misaligned access to RAM, so don't try to work out what it overlaps
+    DoMemoryWrite<T>(ci.address, value);
+    cache.Clear();
+    return;
+  }
+
+  // same as a bus write, skip redundant writes and invalidate any code in the page
+  const u32 offset = ci.address & Bus::g_ram_mask;
+  T old_value;
+  std::memcpy(&old_value, &Bus::g_ram[offset], sizeof(old_value));
+  if (old_value == value)
+    return;
+
+  std::memcpy(&Bus::g_ram[offset], &value, sizeof(value));
+  cache.Invalidate(offset, sizeof(T));
+
+  const u32 page_index = offset / HOST_PAGE_SIZE;
+  if (Bus::m_ram_code_bits[page_index])
+    CPU::CodeCache::InvalidateBlocksWithAddress(page_index, offset);
+}
+
+template<typename T>
+ALWAYS_INLINE static T ReadCompiledCondition(const CheatCode::CompiledInstruction& ci, CheatCode::ConditionCache& cache)
+{
+  // only RAM is cached, anything else could be a register that changes when read
+  if (!(ci.flags & COMPILED_FLAG_DIRECT_RAM))
+    return DoMemoryRead<T>(ci.address);
+
+  const u32 offset = ci.address & Bus::g_ram_mask;
+  u32 value;
+  if (cache.Lookup(offset, sizeof(T), &value))
+    return static_cast<T>(value);
+
+  const T read_value = ReadCompiled<T>(ci);
+  cache.Insert(offset, sizeof(T), read_value);
+  return read_value;
+}
+
+template<typename T>
+static u32 ExecuteCompiled(const CheatCode::CompiledInstruction& ci, u32 index, CheatCode::ConditionCache& cache)
+{
+  switch (static_cast<CompiledOp>(ci.op))
+  {
+    case CompiledOp::Nop:
+      return index + 1;
+
+    case CompiledOp::Write:
+      WriteCompiled<T>(ci, static_cast<T>(ci.value), cache);
+      return index + 1;
+
+    case CompiledOp::BitSet:
+      WriteCompiled<T>(ci, static_cast<T>(ReadCompiled<T>(ci) | static_cast<T>(ci.value)), cache);
+      return index + 1;
+
+    case CompiledOp::BitClear:
+      WriteCompiled<T>(ci, static_cast<T>(ReadCompiled<T>(ci) & ~static_cast<T>(ci.value)), cache);
+      return index + 1;
+
+    case CompiledOp::Add:
+      WriteCompiled<T>(ci, static_cast<T>(ReadCompiled<T>(ci) + static_cast<T>(ci.value)), cache);
+      return index + 1;
+
+    case CompiledOp::Subtract:
+      WriteCompiled<T>(ci, static_cast<T>(ReadCompiled<T>(ci) - static_cast<T>(ci.value)), cache);
+      return index + 1;
+
+    case CompiledOp::CompareButtons:
+      return (ci.value == GetControllerButtonBits()) ? (index + 1) : ci.fail_index;
+
+    default:
+      break;
+  }
+
+  const T value = ReadCompiledCondition<T>(ci, cache);
+
+  bool result;
+  switch (static_cast<CompiledOp>(ci.op))
+  {
+    case CompiledOp::CompareEqual:
+      result = (value == static_cast<T>(ci.value));
+      break;
+    case CompiledOp::CompareNotEqual:
+      result = (value != static_cast<T>(ci.value));
+      break;
+    case CompiledOp::CompareLess:
+      result = (value < static_cast<T>(ci.value));
+      break;
+    case CompiledOp::CompareGreater:
+    default:
+      result = (value > static_cast<T>(ci.value));
+      break;
+  }
+
+  return result ? (index + 1) : ci.fail_index;
+}
+
 void CheatCode::Apply() const
+{
+  ConditionCache cache;
+  Apply(cache);
+}
+
+void CheatCode::Apply(ConditionCache& cache) const
+{
+  if (compiled_instructions.empty())
+  {
+    // the interpreter can write anywhere
+    Interpret();
+    cache.Clear();
+    return;
+  }
+
+  const u32 count = static_cast<u32>(compiled_instructions.size());
+  for (u32 index = 0; index < count;)
+  {
+    const CompiledInstruction& ci = compiled_instructions[index];
+    switch (ci.flags & COMPILED_FLAG_SIZE_MASK)
+    {
+      case 0:
+        index = ExecuteCompiled<u8>(ci, index, cache);
+        break;
+      case 1:
+        index = ExecuteCompiled<u16>(ci, index, cache);
+        break;
+      default:
+        index = ExecuteCompiled<u32>(ci, index, cache);
+        break;
+    }
+  }
+}
+
+void CheatCode::Interpret() const
 {
   const u32 count = static_cast<u32>(instructions.size());
   u32 index = 0;
@@ -2815,112 +3158,496 @@ std::optional<CheatCode::Activation> CheatCode::ParseActivationName(const char*
   return std::nullopt;
 }
 
-MemoryScan::MemoryScan() = default;
+namespace {
+enum : u32
+{
+  // Size of the address range covered by each result block, and the unit of work for search threads.
+  SEARCH_BLOCK_SIZE = 0x10000,
 
-MemoryScan::~MemoryScan() = default;
+  MAX_SEARCH_THREADS = 8,
+};
+} // namespace
 
-void MemoryScan::ResetSearch()
+static u32 ReadScanValue(PhysicalMemoryAddress address, u32 size, bool direct_ram)
 {
-  m_results.clear();
+  if (direct_ram)
+  {
+    u32 value = 0;
+    std::memcpy(&value, &Bus::g_ram[address & Bus::g_ram_mask], size);
+    return value;
+  }
+
+  if (size == sizeof(u8))
+    return DoMemoryRead<u8>(address);
+  else if (size == sizeof(u16))
+    return DoMemoryRead<u16>(address);
+  else
+    return DoMemoryRead<u32>(address);
 }
 
-void MemoryScan::Search()
+static u32 ExtendScanValue(u32 value, u32 size, bool is_signed)
 {
-  m_results.clear();
+  if (size == sizeof(u8))
+    return is_signed ? SignExtend32(Truncate8(value)) : ZeroExtend32(Truncate8(value));
+  else if (size == sizeof(u16))
+    return is_signed ? SignExtend32(Truncate16(value)) : ZeroExtend32(Truncate16(value));
+  else
+    return value;
+}
 
-  switch (m_size)
+/// On the first search, the last value is the same as the value, so every operator reduces to testing whether the
+/// value is within a range. Returns the range as the raw value of its lower bound and its width, and whether the
+/// result should be inverted, so that it can be tested with ((value - low) <= width) in the element's own size.
+static void GetFirstSearchRange(MemoryScan::Operator op, u32 comp_value, bool is_signed, u32 size, u32* low,
+                                u32* width, bool* invert)
+{
+  using Operator = MemoryScan::Operator;
+
+  const u32 bits = size * 8;
+  const s64 min_value = is_signed ? -(s64(1) << (bits - 1)) : 0;
+  const s64 max_value = is_signed ? ((s64(1) << (bits - 1)) - 1) : ((s64(1) << bits) - 1);
+  const s64 value = is_signed ? static_cast<s64>(static_cast<s32>(comp_value)) : static_cast<s64>(comp_value);
+
+  s64 range_min = min_value;
+  s64 range_max = max_value;
+  *invert = false;
+  switch (op)
   {
-    case MemoryAccessSize::Byte:
-      SearchBytes();
+    case Operator::Equal:
+      range_min = range_max = value;
       break;
 
-    case MemoryAccessSize::HalfWord:
-      SearchHalfwords();
+    case Operator::NotEqual:
+      range_min = range_max = value;
+      *invert = true;
       break;
 
-    case MemoryAccessSize::Word:
-      SearchWords();
+    case Operator::GreaterThan:
+      range_min = value + 1;
+      break;
+
+    case Operator::GreaterEqual:
+      range_min = value;
+      break;
+
+    case Operator::LessThan:
+      range_max = value - 1;
+      break;
+
+    case Operator::LessEqual:
+      range_max = value;
+      break;
+
+    case Operator::IncreasedBy:
+    case Operator::DecreasedBy:
+    case Operator::ChangedBy:
+      *invert = (comp_value != 0);
+      break;
+
+    case Operator::NotEqualLast:
+    case Operator::GreaterThanLast:
+    case Operator::LessThanLast:
+      *invert = true;
+      break;
+
+    case Operator::EqualLast:
+    case Operator::GreaterEqualLast:
+    case Operator::LessEqualLast:
+    case Operator::Any:
       break;
 
     default:
+      *invert = true;
       break;
   }
+
+  range_min = std::max(range_min, min_value);
+  range_max = std::min(range_max, max_value);
+  if (range_min > range_max)
+  {
+    // nothing in range, so match everything and invert it
+    range_min = min_value;
+    range_max = max_value;
+    *invert = !*invert;
+  }
+
+  const u32 mask = (size == sizeof(u32)) ? 0xFFFFFFFFu : ((1u << bits) - 1);
+  *low = static_cast<u32>(range_min) & mask;
+  *width = static_cast<u32>(range_max - range_min) & mask;
 }
 
-void MemoryScan::SearchBytes()
+/// Tests a run of elements in RAM against a range, setting a bit for each element in the range.
+template<typename T>
+static void SearchRAMRange(const u8* data, u32 element_count, u32 low, u32 width, bool invert, u64* bitmap)
 {
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address++)
+  static constexpr u32 ELEMENTS_PER_WORD = 64;
+  static constexpr u32 ELEMENTS_PER_VECTOR = 16 / sizeof(T);
+
+  const u32 vector_word_count = element_count / ELEMENTS_PER_WORD;
+  const u64 invert_mask = invert ? ~static_cast<u64>(0) : 0;
+
+#if defined(CPU_X64)
+  // SSE2 only has signed compares, so bias both sides for the unsigned compare.
+  const T sign_bit = static_cast<T>(static_cast<T>(1) << (sizeof(T) * 8 - 1));
+  __m128i vlow, vwidth, vsign;
+  if constexpr (sizeof(T) == sizeof(u8))
   {
-    if (!IsValidScanAddress(address))
-      continue;
+    vlow = _mm_set1_epi8(static_cast<s8>(low));
+    vwidth = _mm_set1_epi8(static_cast<s8>(static_cast<T>(width) ^ sign_bit));
+    vsign = _mm_set1_epi8(static_cast<s8>(sign_bit));
+  }
+  else if constexpr (sizeof(T) == sizeof(u16))
+  {
+    vlow = _mm_set1_epi16(static_cast<s16>(low));
+    vwidth = _mm_set1_epi16(static_cast<s16>(static_cast<T>(width) ^ sign_bit));
+    vsign = _mm_set1_epi16(static_cast<s16>(sign_bit));
+  }
+  else
+  {
+    vlow = _mm_set1_epi32(static_cast<s32>(low));
+    vwidth = _mm_set1_epi32(static_cast<s32>(static_cast<T>(width) ^ sign_bit));
+    vsign = _mm_set1_epi32(static_cast<s32>(sign_bit));
+  }
+
+  for (u32 word = 0; word < vector_word_count; word++)
+  {
+    u64 fail_bits = 0;
+    for (u32 i = 0; i < (ELEMENTS_PER_WORD / ELEMENTS_PER_VECTOR); i++)
+    {
+      const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+      data += 16;
+
+      u32 bits;
+      if constexpr (sizeof(T) == sizeof(u8))
+      {
+        const __m128i diff = _mm_xor_si128(_mm_sub_epi8(value, vlow), vsign);
+        bits = static_cast<u32>(_mm_movemask_epi8(_mm_cmpgt_epi8(diff, vwidth)));
+      }
+      else if constexpr (sizeof(T) == sizeof(u16))
+      {
+        const __m128i diff = _mm_xor_si128(_mm_sub_epi16(value, vlow), vsign);
+        const __m128i fail = _mm_cmpgt_epi16(diff, vwidth);
+        bits = static_cast<u32>(_mm_movemask_epi8(_mm_packs_epi16(fail, fail))) & 0xFFu;
+      }
+      else
+      {
+        const __m128i diff = _mm_xor_si128(_mm_sub_epi32(value, vlow), vsign);
+        bits = static_cast<u32>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(diff, vwidth))));
+      }
+
+      fail_bits |= static_cast<u64>(bits) << (i * ELEMENTS_PER_VECTOR);
+    }
+
+    bitmap[word] = ~fail_bits ^ invert_mask;
+  }
+#elif defined(CPU_AARCH64)
+  // No movemask, so weight each lane by its bit and sum them.
+  for (u32 word = 0; word < vector_word_count; word++)
+  {
+    u64 pass_bits = 0;
+    for (u32 i = 0; i < (ELEMENTS_PER_WORD / ELEMENTS_PER_VECTOR); i++)
+    {
+      u32 bits;
+      if constexpr (sizeof(T) == sizeof(u8))
+      {
+        static constexpr u8 weights[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+        const uint8x8_t vweights = vld1_u8(weights);
+        const uint8x16_t pass = vcleq_u8(vsubq_u8(vld1q_u8(data), vdupq_n_u8(static_cast<u8>(low))),
+                                         vdupq_n_u8(static_cast<u8>(width)));
+        bits = static_cast<u32>(vaddv_u8(vand_u8(vget_low_u8(pass), vweights))) |
+               (static_cast<u32>(vaddv_u8(vand_u8(vget_high_u8(pass), vweights))) << 8);
+      }
+      else if constexpr (sizeof(T) == sizeof(u16))
+      {
+        static constexpr u16 weights[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+        const uint16x8_t pass =
+          vcleq_u16(vsubq_u16(vld1q_u16(reinterpret_cast<const u16*>(data)), vdupq_n_u16(static_cast<u16>(low))),
+                    vdupq_n_u16(static_cast<u16>(width)));
+        bits = vaddvq_u16(vandq_u16(pass, vld1q_u16(weights)));
+      }
+      else
+      {
+        static constexpr u32 weights[4] = {1, 2, 4, 8};
+        const uint32x4_t pass = vcleq_u32(
+          vsubq_u32(vld1q_u32(reinterpret_cast<const u32*>(data)), vdupq_n_u32(low)), vdupq_n_u32(width));
+        bits = vaddvq_u32(vandq_u32(pass, vld1q_u32(weights)));
+      }
+      data += 16;
 
-    const u8 bvalue = DoMemoryRead<u8>(address);
+      pass_bits |= static_cast<u64>(bits) << (i * ELEMENTS_PER_VECTOR);
+    }
 
-    Result res;
-    res.address = address;
-    res.value = m_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
-    res.last_value = res.value;
-    res.value_changed = false;
+    bitmap[word] = pass_bits ^ invert_mask;
+  }
+#else
+  for (u32 word = 0; word < vector_word_count; word++)
+  {
+    u64 pass_bits = 0;
+    for (u32 i = 0; i < ELEMENTS_PER_WORD; i++)
+    {
+      T value;
+      std::memcpy(&value, data, sizeof(value));
+      data += sizeof(value);
+      pass_bits |= static_cast<u64>(static_cast<T>(value - static_cast<T>(low)) <= static_cast<T>(width)) << i;
+    }
+
+    bitmap[word] = pass_bits ^ invert_mask;
+  }
+#endif
+
+  // remaining elements which don't fill a word
+  const u32 remaining = element_count % ELEMENTS_PER_WORD;
+  if (remaining > 0)
+  {
+    u64 pass_bits = 0;
+    for (u32 i = 0; i < remaining; i++)
+    {
+      T value;
+      std::memcpy(&value, data, sizeof(value));
+      data += sizeof(value);
+      pass_bits |= static_cast<u64>(static_cast<T>(value - static_cast<T>(low)) <= static_cast<T>(width)) << i;
+    }
 
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
+    bitmap[vector_word_count] = (pass_bits ^ invert_mask) & ((static_cast<u64>(1) << remaining) - 1);
   }
 }
 
-void MemoryScan::SearchHalfwords()
+/// Calls the function for each block index, spreading the blocks across the pool's threads for large searches.
+template<typename T>
+static void ForEachSearchBlock(std::unique_ptr<cb::ThreadPool>& pool, u32 block_count, u32 search_size, const T& func)
 {
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address += 2)
+  const u32 thread_count =
+    std::min(std::max(cb::ThreadPool::GetNumLogicalCores(), 1u), static_cast<u32>(MAX_SEARCH_THREADS));
+  if (search_size <= Bus::RAM_2MB_SIZE || thread_count <= 1 || block_count <= 1)
   {
-    if (!IsValidScanAddress(address))
-      continue;
+    for (u32 i = 0; i < block_count; i++)
+      func(i);
+
+    return;
+  }
+
+  // The calling thread takes blocks too.
+  if (!pool)
+    pool = std::make_unique<cb::ThreadPool>(static_cast<int>(thread_count - 1));
+
+  std::atomic<u32> next_block{0};
+  const auto worker = [&next_block, block_count, &func]() {
+    for (u32 i = next_block.fetch_add(1, std::memory_order_relaxed); i < block_count;
+         i = next_block.fetch_add(1, std::memory_order_relaxed))
+    {
+      func(i);
+    }
+  };
+
+  // Wait() only waits for the queue to drain, so the futures are used to wait for the workers to finish.
+  std::vector<std::future<void>> workers;
+  workers.reserve(static_cast<u32>(pool->NumWorkers()));
+  for (int i = 0; i < pool->NumWorkers(); i++)
+    workers.push_back(pool->ScheduleAndGetFuture(worker));
+
+  worker();
+
+  for (std::future<void>& future : workers)
+    future.wait();
+}
+
+MemoryScan::MemoryScan() = default;
+
+MemoryScan::~MemoryScan() = default;
+
+void MemoryScan::ResetSearch()
+{
+  m_result_blocks.clear();
+  m_results.clear();
+  m_result_count = 0;
+}
+
+void MemoryScan::Search()
+{
+  ResetSearch();
 
-    const u16 bvalue = DoMemoryRead<u16>(address);
+  if (m_size != MemoryAccessSize::Byte && m_size != MemoryAccessSize::HalfWord && m_size != MemoryAccessSize::Word)
+    return;
 
-    Result res;
-    res.address = address;
-    res.value = m_signed ? SignExtend32(bvalue) : ZeroExtend32(bvalue);
-    res.last_value = res.value;
-    res.value_changed = false;
+  if (m_end_address <= m_start_address)
+    return;
 
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
+  const u32 size = 1u << static_cast<u32>(m_size);
+  const u32 search_size = m_end_address - m_start_address;
+  const u32 block_count = (search_size + (SEARCH_BLOCK_SIZE - 1)) / SEARCH_BLOCK_SIZE;
+  m_result_blocks.resize(block_count);
+  for (u32 i = 0; i < block_count; i++)
+  {
+    ResultBlock& block = m_result_blocks[i];
+    block.start_address = m_start_address + (i * SEARCH_BLOCK_SIZE);
+
+    const u32 block_size = std::min<u32>(m_end_address - block.start_address, SEARCH_BLOCK_SIZE);
+    block.element_count = (block_size + (size - 1)) / size;
+    block.result_count = 0;
+
+    // Aligned elements entirely within RAM can be read straight from it, the rest go through the bus.
+    const u32 element_bytes = block.element_count * size;
+    block.direct_ram = ((block.start_address & (size - 1)) == 0 &&
+                        (block.start_address + element_bytes) <= Bus::RAM_MIRROR_END &&
+                        ((block.start_address & Bus::g_ram_mask) + element_bytes) <= Bus::g_ram_size);
   }
+
+  ForEachSearchBlock(m_search_pool, block_count, search_size, [this](u32 i) { SearchBlock(m_result_blocks[i]); });
+
+  UpdateVisibleResults();
 }
 
-void MemoryScan::SearchWords()
+void MemoryScan::SearchBlock(ResultBlock& block) const
 {
-  for (PhysicalMemoryAddress address = m_start_address; address < m_end_address; address += 4)
+  const u32 size = 1u << static_cast<u32>(m_size);
+  block.bitmap.assign((block.element_count + 63) / 64, 0);
+
+  if (block.direct_ram)
   {
-    if (!IsValidScanAddress(address))
-      continue;
+    // Take a copy, so the values we store are the ones which were tested, even if the game is still running.
+    std::array<u8, SEARCH_BLOCK_SIZE> data;
+    const u32 offset = block.start_address & Bus::g_ram_mask;
+    std::memcpy(data.data(), &Bus::g_ram[offset], block.element_count * size);
+
+    u32 low, width;
+    bool invert;
+    GetFirstSearchRange(m_operator, m_value, m_signed, size, &low, &width, &invert);
+    if (size == sizeof(u8))
+      SearchRAMRange<u8>(data.data(), block.element_count, low, width, invert, block.bitmap.data());
+    else if (size == sizeof(u16))
+      SearchRAMRange<u16>(data.data(), block.element_count, low, width, invert, block.bitmap.data());
+    else
+      SearchRAMRange<u32>(data.data(), block.element_count, low, width, invert, block.bitmap.data());
+
+    for (const u64 word : block.bitmap)
+      block.result_count += static_cast<u32>(std::bitset<64>(word).count());
+
+    block.values.resize(block.result_count * size);
+    u8* out_value = block.values.data();
+    for (u32 word = 0; word < static_cast<u32>(block.bitmap.size()); word++)
+    {
+      for (u64 bits = block.bitmap[word]; bits != 0; bits &= (bits - 1))
+      {
+        const u32 index = (word * 64) + CountTrailingZeros(bits);
+        std::memcpy(out_value, &data[index * size], size);
+        out_value += size;
+      }
+    }
+  }
+  else
+  {
+    for (u32 index = 0; index < block.element_count; index++)
+    {
+      const PhysicalMemoryAddress address = block.start_address + (index * size);
+      if (!IsValidScanAddress(address))
+        continue;
+
+      const u32 raw_value = ReadScanValue(address, size, false);
+
+      Result res;
+      res.address = address;
+      res.value = ExtendScanValue(raw_value, size, m_signed);
+      res.last_value = res.value;
+      res.value_changed = false;
+      if (!res.Filter(m_operator, m_value, m_signed))
+        continue;
 
-    Result res;
-    res.address = address;
-    res.value = DoMemoryRead<u32>(address);
-    res.last_value = res.value;
-    res.value_changed = false;
+      block.bitmap[index / 64] |= static_cast<u64>(1) << (index % 64);
+      block.values.resize((block.result_count + 1) * size);
+      std::memcpy(&block.values[block.result_count * size], &raw_value, size);
+      block.result_count++;
+    }
+  }
 
-    if (res.Filter(m_operator, m_value, m_signed))
-      m_results.push_back(res);
+  if (block.result_count == 0)
+  {
+    block.bitmap = {};
+    block.values = {};
   }
 }
 
 void MemoryScan::SearchAgain()
 {
-  ResultVector new_results;
-  new_results.reserve(m_results.size());
-  for (Result& res : m_results)
-  {
-    res.UpdateValue(m_size, m_signed);
+  const u32 search_size = m_end_address - m_start_address;
+  ForEachSearchBlock(m_search_pool, static_cast<u32>(m_result_blocks.size()), search_size,
+                     [this](u32 i) { SearchBlockAgain(m_result_blocks[i]); });
+
+  m_result_blocks.erase(std::remove_if(m_result_blocks.begin(), m_result_blocks.end(),
+                                       [](const ResultBlock& block) { return (block.result_count == 0); }),
+                        m_result_blocks.end());
+
+  UpdateVisibleResults();
+}
 
-    if (res.Filter(m_operator, m_value, m_signed))
+void MemoryScan::SearchBlockAgain(ResultBlock& block) const
+{
+  const u32 size = 1u << static_cast<u32>(m_size);
+
+  // Results only ever get removed, so the values can be compacted in place.
+  u32 in_index = 0;
+  u32 out_index = 0;
+  for (u32 word = 0; word < static_cast<u32>(block.bitmap.size()); word++)
+  {
+    u64 new_bits = 0;
+    for (u64 bits = block.bitmap[word]; bits != 0; bits &= (bits - 1))
     {
-      res.last_value = res.value;
-      new_results.push_back(res);
+      const u32 bit = CountTrailingZeros(bits);
+      const PhysicalMemoryAddress address = block.start_address + (((word * 64) + bit) * size);
+
+      u32 last_raw_value = 0;
+      std::memcpy(&last_raw_value, &block.values[in_index * size], size);
+      in_index++;
+
+      const u32 raw_value = ReadScanValue(address, size, block.direct_ram);
+
+      Result res;
+      res.address = address;
+      res.value = ExtendScanValue(raw_value, size, m_signed);
+      res.last_value = ExtendScanValue(last_raw_value, size, m_signed);
+      res.value_changed = false;
+      if (!res.Filter(m_operator, m_value, m_signed))
+        continue;
+
+      std::memcpy(&block.values[out_index * size], &raw_value, size);
+      out_index++;
+      new_bits |= static_cast<u64>(1) << bit;
     }
+
+    block.bitmap[word] = new_bits;
   }
 
-  m_results.swap(new_results);
+  block.result_count = out_index;
+  block.values.resize(out_index * size);
+}
+
+void MemoryScan::UpdateVisibleResults()
+{
+  const u32 size = 1u << static_cast<u32>(m_size);
+
+  m_results.clear();
+  m_result_count = 0;
+  for (const ResultBlock& block : m_result_blocks)
+  {
+    m_result_count += block.result_count;
+
+    u32 value_index = 0;
+    for (u32 word = 0; word < static_cast<u32>(block.bitmap.size()) && m_results.size() < MAX_VISIBLE_RESULTS;
+         word++)
+    {
+      for (u64 bits = block.bitmap[word]; bits != 0 && m_results.size() < MAX_VISIBLE_RESULTS; bits &= (bits - 1))
+      {
+        u32 raw_value = 0;
+        std::memcpy(&raw_value, &block.values[value_index * size], size);
+        value_index++;
+
+        Result& res = m_results.emplace_back();
+        res.address = block.start_address + (((word * 64) + CountTrailingZeros(bits)) * size);
+        res.value = ExtendScanValue(raw_value, size, m_signed);
+        res.last_value = res.value;
+        res.value_changed = false;
+      }
+    }
+  }
 }
 
 void MemoryScan::UpdateResultsValues()
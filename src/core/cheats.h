@@ -4,10 +4,15 @@
 #pragma once
 #include "common/bitfield.h"
 #include "types.h"
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
 
+namespace cb {
+class ThreadPool;
+}
+
 struct CheatCode
 {
   enum class Type : u8
@@ -107,6 +112,16 @@ struct CheatCode
     BitField<u64, u8, 0, 8> value8;
   };
 
+  /// Instruction lowered from the code when it is loaded, so it doesn't need to be decoded every frame.
+  struct CompiledInstruction
+  {
+    u32 address; // Masked to RAM for direct accesses, otherwise passed to the bus.
+    u32 value;
+    u16 fail_index; // Instruction to continue at when a comparison fails.
+    u8 op;
+    u8 flags;
+  };
+
   std::string group;
   std::string description;
   std::vector<Instruction> instructions;
@@ -115,6 +130,12 @@ struct CheatCode
   Activation activation = Activation::EndFrame;
   bool enabled = false;
 
+  /// Empty when the code hasn't been compiled, or uses instructions which can't be compiled.
+  std::vector<CompiledInstruction> compiled_instructions;
+
+  /// Values read by conditions, shared by all codes applied in one CheatList::Apply().
+  struct ConditionCache;
+
   ALWAYS_INLINE bool Valid() const { return !instructions.empty() && !description.empty(); }
   ALWAYS_INLINE bool IsManuallyActivated() const { return (activation == Activation::Manual); }
 
@@ -124,8 +145,13 @@ struct CheatCode
   u32 GetNextNonConditionalInstruction(u32 index) const;
 
   void Apply() const;
+  void Apply(ConditionCache& cache) const;
   void ApplyOnDisable() const;
 
+  /// Lowers the instructions to compiled form. Must be called after the instructions are changed.
+  void Compile();
+  void Interpret() const;
+
   static const char* GetTypeName(Type type);
   static const char* GetTypeDisplayName(Type type);
   static std::optional<Type> ParseTypeName(const char* str);
@@ -235,6 +261,9 @@ public:
 
   using ResultVector = std::vector<Result>;
 
+  /// Number of results which are kept with their values for display. Beyond this, only the count is available.
+  static constexpr u32 MAX_VISIBLE_RESULTS = 5000;
+
   MemoryScan();
   ~MemoryScan();
 
@@ -246,7 +275,7 @@ public:
   PhysicalMemoryAddress GetEndAddress() const { return m_end_address; }
   const ResultVector& GetResults() const { return m_results; }
   const Result& GetResult(u32 index) const { return m_results[index]; }
-  u32 GetResultCount() const { return static_cast<u32>(m_results.size()); }
+  u32 GetResultCount() const { return m_result_count; }
 
   void SetValue(u32 value) { m_value = value; }
   void SetValueSigned(bool s) { m_signed = s; }
@@ -263,17 +292,34 @@ public:
   void SetResultValue(u32 index, u32 value);
 
 private:
-  void SearchBytes();
-  void SearchHalfwords();
-  void SearchWords();
+  /// Results within a block of the search range, as a bitmap of matching elements, and the values at the last search
+  /// of those elements packed in address order.
+  struct ResultBlock
+  {
+    PhysicalMemoryAddress start_address;
+    u32 element_count;
+    u32 result_count;
+    bool direct_ram;
+    std::vector<u64> bitmap;
+    std::vector<u8> values;
+  };
+
+  void SearchBlock(ResultBlock& block) const;
+  void SearchBlockAgain(ResultBlock& block) const;
+  void UpdateVisibleResults();
 
   u32 m_value = 0;
   MemoryAccessSize m_size = MemoryAccessSize::HalfWord;
   Operator m_operator = Operator::Equal;
   PhysicalMemoryAddress m_start_address = 0;
   PhysicalMemoryAddress m_end_address = 0x200000;
+  std::vector<ResultBlock> m_result_blocks;
   ResultVector m_results;
+  u32 m_result_count = 0;
   bool m_signed = false;
+
+  // Started by the first search which is large enough, and kept for later ones.
+  std::unique_ptr<cb::ThreadPool> m_search_pool;
 };
 
 class MemoryWatchList
@@ -4,7 +4,11 @@
 #include "cpu_code_cache.h"
 #include "bus.h"
 #include "common/assert.h"
+#include "common/byte_stream.h"
+#include "common/file_system.h"
 #include "common/log.h"
+#include "common/path.h"
+#include "common/threading.h"
 #include "cpu_core.h"
 #include "cpu_core_private.h"
 #include "cpu_disasm.h"
@@ -12,12 +16,22 @@
 #include "settings.h"
 #include "system.h"
 #include "timing_event.h"
+
+#include "fmt/format.h"
+
 Log_SetChannel(CPU::CodeCache);
 
 #ifdef WITH_RECOMPILER
 #include "cpu_recompiler_code_generator.h"
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
 #include <zlib.h>
 
 namespace CPU::CodeCache {
@@ -29,6 +43,20 @@ static constexpr u32 RECOMPILE_FRAMES_TO_FALL_BACK_TO_INTERPRETER = 100;
 static constexpr u32 RECOMPILE_COUNT_TO_FALL_BACK_TO_INTERPRETER = 20;
 static constexpr u32 INVALIDATE_THRESHOLD_TO_DISABLE_LINKING = 10;
 
+// Traces are kept short and close together, so that they don't cover too many code pages.
+static constexpr u32 MAX_TRACE_BLOCKS = 8;
+static constexpr u32 MAX_TRACE_INSTRUCTIONS = 256;
+static constexpr u32 MAX_TRACE_CODE_SPAN = HOST_PAGE_SIZE;
+
+// Persistent block analysis cache.
+static constexpr u32 BLOCK_CACHE_SIGNATURE = 0x43424344; // DCBC
+static constexpr u32 BLOCK_CACHE_VERSION = 1;
+static constexpr u32 BLOCK_CACHE_MAX_ENTRIES = 65536;
+static constexpr u32 BLOCK_CACHE_MAX_INSTRUCTIONS = 4096;
+static constexpr u32 BLOCK_CACHE_MAX_SUCCESSORS = 8;
+static constexpr u32 BLOCK_CACHE_MAX_PRECOMPILE_QUEUE = 1024;
+static constexpr u32 BLOCK_CACHE_PRECOMPILES_PER_FRAME = 64;
+
 #ifdef WITH_RECOMPILER
 
 // Currently remapping the code buffer doesn't work in macOS or Haiku.
@@ -54,6 +82,11 @@ alignas(Recompiler::CODE_STORAGE_ALIGNMENT) static u8
 
 static JitCodeBuffer s_code_buffer;
 
+// Background compilation is given the code buffer a chunk at a time, so it can fill the whole buffer.
+static constexpr u32 RECOMPILER_ASYNC_CODE_CHUNK_SIZE = RECOMPILER_CODE_CACHE_SIZE / 32;
+static constexpr u32 RECOMPILER_ASYNC_FAR_CODE_CHUNK_SIZE = RECOMPILER_FAR_CODE_CACHE_SIZE / 32;
+static JitCodeBuffer s_async_code_buffer;
+
 #endif
 
 #ifdef WITH_RECOMPILER
@@ -92,6 +125,10 @@ static void CompileDispatcher();
 static void FastCompileBlockFunction();
 static void InvalidCodeFunction();
 
+static bool IsTraceableBlock(const CodeBlock* block);
+static bool EndsWithDirectBranch(const CodeBlock* block);
+static void CompileTrace(CodeBlock* head);
+
 static constexpr u32 GetTableCount(u32 start, u32 end)
 {
   return ((end >> FAST_MAP_TABLE_SHIFT) - (start >> FAST_MAP_TABLE_SHIFT)) + 1;
@@ -196,8 +233,150 @@ static void SetFastMap(u32 pc, CodeBlock::HostCodePointer function)
 
 #endif
 
-using BlockMap = std::unordered_map<u32, CodeBlock*>;
-using HostCodeMap = std::map<CodeBlock::HostCodePointer, CodeBlock*>;
+/// Open-addressed block lookup table, keyed on the CodeBlockKey bits. Blocks which have fallen back to the interpreter
+/// are stored as null entries. Linear probing with backwards-shift deletion is used, so removal leaves no tombstones.
+class BlockMap
+{
+public:
+  /// Bit 1 of a block key is never set, so this can never collide with a real key.
+  static constexpr u32 EMPTY_KEY = 0xFFFFFFFFu;
+  static constexpr u32 INITIAL_CAPACITY = 16384;
+
+  struct Entry
+  {
+    u32 key;
+    CodeBlock* block;
+  };
+
+  ALWAYS_INLINE bool IsEmpty() const { return (m_size == 0); }
+
+  /// Returns a pointer to the block slot for the key, or null if the key is not present.
+  ALWAYS_INLINE CodeBlock** Find(u32 key)
+  {
+    if (m_entries.empty())
+      return nullptr;
+
+    for (u32 index = Hash(key) & m_mask;; index = (index + 1) & m_mask)
+    {
+      Entry& entry = m_entries[index];
+      if (entry.key == key)
+        return &entry.block;
+      else if (entry.key == EMPTY_KEY)
+        return nullptr;
+    }
+  }
+
+  /// Inserts the key if it is not already present. Existing entries are not replaced.
+  void Insert(u32 key, CodeBlock* block)
+  {
+    DebugAssert(key != EMPTY_KEY);
+    if (((m_size + 1) * 2) > static_cast<u32>(m_entries.size()))
+      Grow();
+
+    for (u32 index = Hash(key) & m_mask;; index = (index + 1) & m_mask)
+    {
+      Entry& entry = m_entries[index];
+      if (entry.key == key)
+        return;
+
+      if (entry.key == EMPTY_KEY)
+      {
+        entry.key = key;
+        entry.block = block;
+        m_size++;
+        return;
+      }
+    }
+  }
+
+  /// Removes the key, returning false if it was not present.
+  bool Remove(u32 key)
+  {
+    if (m_entries.empty())
+      return false;
+
+    u32 index = Hash(key) & m_mask;
+    for (;; index = (index + 1) & m_mask)
+    {
+      if (m_entries[index].key == key)
+        break;
+      else if (m_entries[index].key == EMPTY_KEY)
+        return false;
+    }
+
+    // Shift back any following entries in the probe sequence which would no longer be reachable.
+    for (u32 next = (index + 1) & m_mask;; next = (next + 1) & m_mask)
+    {
+      const Entry& entry = m_entries[next];
+      if (entry.key == EMPTY_KEY)
+        break;
+
+      const u32 ideal = Hash(entry.key) & m_mask;
+      if (((next - ideal) & m_mask) >= ((next - index) & m_mask))
+      {
+        m_entries[index] = entry;
+        index = next;
+      }
+    }
+
+    m_entries[index].key = EMPTY_KEY;
+    m_entries[index].block = nullptr;
+    m_size--;
+    return true;
+  }
+
+  /// Removes all entries, retaining the storage.
+  void Clear()
+  {
+    if (m_size == 0)
+      return;
+
+    for (Entry& entry : m_entries)
+    {
+      entry.key = EMPTY_KEY;
+      entry.block = nullptr;
+    }
+    m_size = 0;
+  }
+
+  /// Calls the callback for every entry, including null (interpreter fallback) entries.
+  template<typename T>
+  void ForEach(const T& callback)
+  {
+    for (const Entry& entry : m_entries)
+    {
+      if (entry.key != EMPTY_KEY)
+        callback(entry.block);
+    }
+  }
+
+private:
+  ALWAYS_INLINE static u32 Hash(u32 key)
+  {
+    // Fibonacci hash, with the high bits folded down since the table is indexed with a mask.
+    const u32 hash = key * 0x9E3779B1u;
+    return hash ^ (hash >> 16);
+  }
+
+  void Grow()
+  {
+    std::vector<Entry> old_entries(std::move(m_entries));
+    const u32 new_capacity = old_entries.empty() ? INITIAL_CAPACITY : static_cast<u32>(old_entries.size()) * 2;
+    m_entries.assign(new_capacity, Entry{EMPTY_KEY, nullptr});
+    m_mask = new_capacity - 1;
+    m_size = 0;
+
+    for (const Entry& entry : old_entries)
+    {
+      if (entry.key != EMPTY_KEY)
+        Insert(entry.key, entry.block);
+    }
+  }
+
+  std::vector<Entry> m_entries;
+  u32 m_mask = 0;
+  u32 m_size = 0;
+};
 
 void LogCurrentState();
 
@@ -207,11 +386,27 @@ static CodeBlockKey GetNextBlockKey();
 /// Looks up the block in the cache if it's already been compiled.
 static CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush);
 
+/// Fills in the instructions and analysis flags for a block which is about to be compiled.
+static bool PrepareBlockForCompile(CodeBlock* block);
+static void UpdateBlockCodeRange(CodeBlock* block);
+
+/// Compiles the block, or hands it to the compile thread if background compilation is enabled.
+static bool CompileOrQueueBlock(CodeBlock* block, bool allow_flush);
+
 /// Can the current block execute? This will re-validate the block if necessary.
 /// The block can also be flushed if recompilation failed, so ignore the pointer if false is returned.
 static bool RevalidateBlock(CodeBlock* block, bool allow_flush);
 
 static bool CompileBlock(CodeBlock* block, bool allow_flush);
+
+/// Decodes the guest instructions for a block, filling in the instruction list.
+static bool AnalyzeBlock(CodeBlock* block);
+
+/// Returns true if the block is a short loop back to itself, which only reads memory and registers.
+static bool IsIdleLoopBlock(const CodeBlock* block);
+
+/// Finds pairs of instructions which the cached interpreter can execute together.
+static void FuseBlockInstructions(CodeBlock* block);
 static void RemoveReferencesToBlock(CodeBlock* block);
 static void AddBlockToPageMap(CodeBlock* block);
 static void RemoveBlockFromPageMap(CodeBlock* block);
@@ -224,15 +419,138 @@ static void UnlinkBlock(CodeBlock* block);
 
 static void ClearState();
 
+/// Returns a block from the pool, reusing the storage of previously-freed blocks where possible.
+static CodeBlock* AllocateBlock(CodeBlockKey key);
+static void FreeBlock(CodeBlock* block);
+static void FreeBlockPool();
+
+static constexpr u32 BLOCK_POOL_CHUNK_SIZE = 1024;
+
+struct CachedBlockAnalysis
+{
+  u32 code_hash;
+  bool contains_double_branches;
+  std::vector<CodeBlockInstruction> instructions;
+  std::vector<u32> successors;
+
+  // Not saved. Page write count when the code was last known to match, so it doesn't have to be checked again.
+  u32 validated_epoch = 0;
+  u32 validated_write_count = 0;
+};
+using BlockAnalysisMap = std::unordered_map<u32, CachedBlockAnalysis>;
+
+static std::string GetBlockCacheFileName(const std::string_view& serial);
+static void LoadBlockCache();
+static void SaveBlockCache();
+static u32 GetInstructionCodeHash(const std::vector<CodeBlockInstruction>& instructions);
+static bool IsCachedBlockAnalysisValid(const CachedBlockAnalysis& analysis);
+static void MarkBlockAnalysisValidated(const CodeBlock* block);
+static void BumpRAMCodePageWriteCount(u32 page_index);
+
+/// Fills in the block's instructions from the persistent cache, if the guest code hasn't changed.
+static bool ApplyCachedBlockAnalysis(CodeBlock* block);
+static void RecordBlockAnalysis(const CodeBlock* block);
+static void RecordBlockSuccessor(const CodeBlock* from, const CodeBlock* to);
+
+/// Queues any cached successors of the block which haven't been compiled yet.
+static void QueueCachedSuccessors(const CodeBlock* block);
+
+/// Compiles a few of the queued successors, spreading the work across frames.
+static void PrecompileQueuedSuccessors();
+
+// Code pages are split into smaller regions, so that writes to data which shares a page with code don't have to
+// invalidate every block in the page.
+static constexpr u32 CODE_SUBPAGE_SIZE = 256;
+static constexpr u32 CODE_SUBPAGES_PER_PAGE = HOST_PAGE_SIZE / CODE_SUBPAGE_SIZE;
+static_assert(CODE_SUBPAGES_PER_PAGE <= 64);
+
+static u64 GetSubPageMask(u32 page_index, u32 start_address, u32 end_address);
+#ifdef WITH_MMAP_FASTMEM
+static bool IsCodeSubPageAddress(PhysicalMemoryAddress address);
+#endif
+static void UpdateSubPageMask(u32 page_index);
+static void RemoveInvalidatedBlockFromOtherPages(CodeBlock* block, u32 page_index);
+
 static BlockMap s_blocks;
 static std::array<std::vector<CodeBlock*>, Bus::RAM_8MB_CODE_PAGE_COUNT> m_ram_block_map;
+static std::array<u64, Bus::RAM_8MB_CODE_PAGE_COUNT> s_ram_code_subpage_masks = {};
+static std::vector<std::unique_ptr<CodeBlock[]>> s_block_pool_chunks;
+static std::vector<CodeBlock*> s_free_blocks;
+
+static Statistics s_statistics = {};
+
+static std::string s_block_cache_serial;
+static BlockAnalysisMap s_block_cache;
+static bool s_block_cache_dirty = false;
+static bool s_block_cache_precompiling = false;
+static std::vector<u32> s_block_cache_precompile_queue;
+static u32 s_block_cache_precompile_frame = 0;
+static u32 s_block_cache_precompile_count = 0;
+
+// Bumped whenever code in a page is written, or the page stops being write-tracked. Cached analysis which was
+// validated while the page was tracked stays valid as long as the count doesn't change. The epoch covers every page,
+// and changes when all tracking is dropped.
+static std::array<u32, Bus::RAM_8MB_CODE_PAGE_COUNT> s_ram_code_page_write_counts = {};
+static u32 s_block_cache_epoch = 1;
 
 #ifdef WITH_RECOMPILER
+struct HostCodeRange
+{
+  uintptr_t start;
+  uintptr_t end;
+  CodeBlock* block;
+};
+
+/// Host code ranges, sorted by start address. Blocks are allocated linearly from the code buffer, so insertions are
+/// almost always appends.
+using HostCodeMap = std::vector<HostCodeRange>;
 static HostCodeMap s_host_code_map;
 
+/// Returns the block whose host code contains the specified address, or null if it is not part of any block.
+static CodeBlock* LookupBlockByHostPC(const void* host_pc);
+
 static void AddBlockToHostCodeMap(CodeBlock* block);
 static void RemoveBlockFromHostCodeMap(CodeBlock* block);
 
+// When background compilation is enabled, new blocks are analyzed on the CPU thread and interpreted until the compile
+// thread has generated code for them in s_async_code_buffer. The compile thread only reads the block, everything else
+// (publishing to the fast map, linking, the host code map) happens on the CPU thread in PublishCompiledBlocks().
+struct AsyncCompileJob
+{
+  CodeBlock* block;
+  Registers regs;
+  u32 cop0_sr;
+};
+
+struct AsyncCompileResult
+{
+  CodeBlock* block;
+  CodeBlock::HostCodePointer host_code;
+  u32 host_code_size;
+};
+
+static void StartCompileThread();
+static void StopCompileThread();
+static void CompileThreadEntryPoint();
+static bool QueueCompileBlock(CodeBlock* block);
+static void CancelQueuedCompiles();
+static void PublishCompiledBlocks();
+
+/// Gives the compile thread the next chunk of the code buffer. It must not be compiling while this happens.
+static bool SplitAsyncCodeBuffer();
+
+static std::thread s_compile_thread;
+static std::mutex s_compile_mutex;
+static std::condition_variable s_compile_work_cv;
+static std::condition_variable s_compile_done_cv;
+static std::deque<AsyncCompileJob> s_compile_queue;
+static std::vector<AsyncCompileResult> s_compile_results;
+static std::vector<AsyncCompileResult> s_compile_results_to_publish;
+static std::atomic_bool s_compile_results_ready{false};
+static bool s_compile_thread_busy = false;
+static bool s_compile_thread_out_of_space = false;
+static bool s_compile_thread_shutdown = false;
+
 static bool InitializeFastmem();
 static void ShutdownFastmem();
 static Common::PageFaultHandler::HandlerResult LUTPageFaultHandler(void* exception_pc, void* fault_address,
@@ -245,7 +563,8 @@ static Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* except
 
 void Initialize()
 {
-  Assert(s_blocks.empty());
+  Assert(s_blocks.IsEmpty());
+  s_statistics = {};
 
 #ifdef WITH_RECOMPILER
   if (g_settings.IsUsingRecompiler())
@@ -272,6 +591,9 @@ void Initialize()
     if (g_settings.IsUsingFastmem() && !InitializeFastmem())
       Panic("Failed to initialize fastmem");
 
+    if (g_settings.cpu_recompiler_async_compile)
+      StartCompileThread();
+
     AllocateFastMap();
     CompileDispatcher();
     ResetFastMap();
@@ -281,17 +603,30 @@ void Initialize()
 
 void ClearState()
 {
+#ifdef WITH_RECOMPILER
+  // Don't free blocks out from under the compile thread.
+  if (s_compile_thread.joinable())
+    CancelQueuedCompiles();
+#endif
+
   Bus::ClearRAMCodePageFlags();
   for (auto& it : m_ram_block_map)
     it.clear();
+  s_ram_code_subpage_masks.fill(0);
+  s_block_cache_epoch++;
+  s_block_cache_precompile_queue.clear();
 
-  for (const auto& it : s_blocks)
-    delete it.second;
+  s_blocks.ForEach([](CodeBlock* block) {
+    if (block)
+      FreeBlock(block);
+  });
 
-  s_blocks.clear();
+  s_blocks.Clear();
 #ifdef WITH_RECOMPILER
   s_host_code_map.clear();
   s_code_buffer.Reset();
+  if (s_compile_thread.joinable())
+    SplitAsyncCodeBuffer();
   ResetFastMap();
 #endif
 }
@@ -299,9 +634,13 @@ void ClearState()
 void Shutdown()
 {
   ClearState();
+  FreeBlockPool();
+  SetBlockCacheSerial({});
 #ifdef WITH_RECOMPILER
+  StopCompileThread();
   ShutdownFastmem();
   FreeFastMap();
+  s_async_code_buffer.Destroy();
   s_code_buffer.Destroy();
 #endif
 }
@@ -487,10 +826,12 @@ void Reinitialize()
   ClearState();
 
 #ifdef WITH_RECOMPILER
+  StopCompileThread();
   ShutdownFastmem();
 #endif
 
 #if defined(WITH_RECOMPILER)
+  s_async_code_buffer.Destroy();
   s_code_buffer.Destroy();
 
   if (g_settings.IsUsingRecompiler())
@@ -513,6 +854,9 @@ void Reinitialize()
     if (g_settings.IsUsingFastmem() && !InitializeFastmem())
       Panic("Failed to initialize fastmem");
 
+    if (g_settings.cpu_recompiler_async_compile)
+      StartCompileThread();
+
     AllocateFastMap();
     CompileDispatcher();
     ResetFastMap();
@@ -522,6 +866,7 @@ void Reinitialize()
 
 void Flush()
 {
+  s_statistics.flushes++;
   ClearState();
 #ifdef WITH_RECOMPILER
   if (g_settings.IsUsingRecompiler())
@@ -529,6 +874,11 @@ void Flush()
 #endif
 }
 
+const Statistics& GetStatistics()
+{
+  return s_statistics;
+}
+
 #ifndef _MSC_VER
 void __debugbreak() {}
 #endif
@@ -567,24 +917,81 @@ CodeBlockKey GetNextBlockKey()
   return key;
 }
 
-// assumes it has already been unlinked
+CodeBlock* AllocateBlock(CodeBlockKey key)
+{
+  if (s_free_blocks.empty())
+  {
+    std::unique_ptr<CodeBlock[]> chunk = std::make_unique<CodeBlock[]>(BLOCK_POOL_CHUNK_SIZE);
+    s_free_blocks.reserve(s_free_blocks.size() + BLOCK_POOL_CHUNK_SIZE);
+    for (u32 i = BLOCK_POOL_CHUNK_SIZE; i > 0; i--)
+      s_free_blocks.push_back(&chunk[i - 1]);
+    s_block_pool_chunks.push_back(std::move(chunk));
+  }
+
+  CodeBlock* block = s_free_blocks.back();
+  s_free_blocks.pop_back();
+
+  // Reset everything, but hang on to the vector storage for the next block.
+  block->key = key;
+  block->host_code_size = 0;
+  block->host_code = nullptr;
+  block->instructions.clear();
+  block->link_predecessors.clear();
+  block->link_successors.clear();
+  block->uncached_fetch_ticks = 0;
+  block->icache_line_count = 0;
+#ifdef WITH_RECOMPILER
+  block->loadstore_backpatch_info.clear();
+#endif
+  block->contains_loadstore_instructions = false;
+  block->contains_double_branches = false;
+  block->invalidated = false;
+  block->can_link = true;
+  block->compile_pending = false;
+  block->is_trace = false;
+  block->recompile_frame_number = 0;
+  block->recompile_count = 0;
+  block->invalidate_frame_number = 0;
+  block->execution_count = 0;
+  return block;
+}
+
+void FreeBlock(CodeBlock* block)
+{
+  // Links are not cleared here, as a flush discards all blocks at once.
+  s_free_blocks.push_back(block);
+}
+
+void FreeBlockPool()
+{
+  s_free_blocks.clear();
+  s_block_pool_chunks.clear();
+}
+
+// assumes it has already been unlinked and removed from the block map
 static void FallbackExistingBlockToInterpreter(CodeBlock* block)
 {
   // Replace with null so we don't try to compile it again.
-  s_blocks.emplace(block->key.bits, nullptr);
-  delete block;
+  Assert(!s_blocks.Find(block->key.bits));
+  s_statistics.interpreter_fallbacks++;
+  s_blocks.Insert(block->key.bits, nullptr);
+  FreeBlock(block);
 }
 
 CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush)
 {
-  BlockMap::iterator iter = s_blocks.find(key.bits);
-  if (iter != s_blocks.end())
+  CodeBlock** existing_block_ptr = s_blocks.Find(key.bits);
+  if (existing_block_ptr)
   {
     // ensure it hasn't been invalidated
-    CodeBlock* existing_block = iter->second;
+    CodeBlock* existing_block = *existing_block_ptr;
     if (!existing_block || !existing_block->invalidated)
       return existing_block;
 
+    // blocks still being compiled can't be revalidated until they're published, so run the new code uncached
+    if (existing_block->compile_pending)
+      return nullptr;
+
     // if compilation fails or we're forced back to the interpreter, bail out
     if (RevalidateBlock(existing_block, allow_flush))
       return existing_block;
@@ -592,28 +999,42 @@ CodeBlock* LookupBlock(CodeBlockKey key, bool allow_flush)
       return nullptr;
   }
 
-  CodeBlock* block = new CodeBlock(key);
+  CodeBlock* block = AllocateBlock(key);
   block->recompile_frame_number = System::GetFrameNumber();
 
-  if (CompileBlock(block, allow_flush))
+  if (CompileOrQueueBlock(block, allow_flush))
   {
+    s_statistics.blocks_compiled++;
+
     // add it to the page map if it's in ram
     AddBlockToPageMap(block);
+    if (!s_block_cache.empty())
+      MarkBlockAnalysisValidated(block);
 
 #ifdef WITH_RECOMPILER
-    SetFastMap(block->GetPC(), block->host_code);
-    AddBlockToHostCodeMap(block);
+    if (!block->compile_pending)
+    {
+      SetFastMap(block->GetPC(), block->host_code);
+      AddBlockToHostCodeMap(block);
+    }
 #endif
   }
   else
   {
     Log_ErrorPrintf("Failed to compile block at PC=0x%08X", key.GetPC());
-    delete block;
+    FreeBlock(block);
     block = nullptr;
   }
 
   if (block || allow_flush)
-    s_blocks.emplace(key.bits, block);
+    s_blocks.Insert(key.bits, block);
+
+  if (!s_block_cache.empty())
+  {
+    if (block)
+      QueueCachedSuccessors(block);
+    PrecompileQueuedSuccessors();
+  }
 
   return block;
 }
@@ -673,8 +1094,9 @@ recompile:
   }
 
   block->instructions.clear();
+  s_statistics.blocks_recompiled++;
 
-  if (!CompileBlock(block, allow_flush))
+  if (!CompileOrQueueBlock(block, allow_flush))
   {
     Log_PerfPrintf("Failed to recompile block 0x%08X, falling back to interpreter.", block->GetPC());
     FallbackExistingBlockToInterpreter(block);
@@ -685,19 +1107,104 @@ recompile:
 
 #ifdef WITH_RECOMPILER
   // re-add to page map again
-  SetFastMap(block->GetPC(), block->host_code);
-  AddBlockToHostCodeMap(block);
+  if (!block->compile_pending)
+  {
+    SetFastMap(block->GetPC(), block->host_code);
+    AddBlockToHostCodeMap(block);
+  }
 #endif
 
   // block is valid again
   block->invalidated = false;
 
   // re-insert into the block map since we removed it earlier.
-  s_blocks.emplace(block->key.bits, block);
+  s_blocks.Insert(block->key.bits, block);
+  return true;
+}
+
+bool PrepareBlockForCompile(CodeBlock* block)
+{
+  if (!ApplyCachedBlockAnalysis(block) && !AnalyzeBlock(block))
+    return false;
+
+  FuseBlockInstructions(block);
+  block->is_idle_loop = IsIdleLoopBlock(block);
+  block->idle_loop_last_timestamp = 0;
+  block->idle_loop_iteration_ticks = 0;
+  block->is_trace = false;
+  block->execution_count = 0;
+  UpdateBlockCodeRange(block);
   return true;
 }
 
+void UpdateBlockCodeRange(CodeBlock* block)
+{
+  block->code_start_address = block->key.GetPCPhysicalAddress();
+  block->code_end_address = block->code_start_address;
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    const u32 address = cbi.pc & PHYSICAL_MEMORY_ADDRESS_MASK;
+    block->code_start_address = std::min(block->code_start_address, address);
+    block->code_end_address = std::max(block->code_end_address, address + static_cast<u32>(sizeof(Instruction)));
+  }
+}
+
+bool CompileOrQueueBlock(CodeBlock* block, bool allow_flush)
+{
+#ifdef WITH_RECOMPILER
+  if (s_compile_thread.joinable())
+    return QueueCompileBlock(block);
+#endif
+
+  return CompileBlock(block, allow_flush);
+}
+
 bool CompileBlock(CodeBlock* block, bool allow_flush)
+{
+  if (!PrepareBlockForCompile(block))
+    return false;
+
+#ifdef WITH_RECOMPILER
+  if (g_settings.IsUsingRecompiler())
+  {
+    // Ensure we're not going to run out of space while compiling this block.
+    if (s_code_buffer.GetFreeCodeSpace() <
+          (block->instructions.size() * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) ||
+        s_code_buffer.GetFreeFarCodeSpace() <
+          (block->instructions.size() * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION))
+    {
+      if (allow_flush)
+      {
+        Log_WarningPrintf("Out of code space, flushing all blocks.");
+        Flush();
+      }
+      else
+      {
+        Log_ErrorPrintf("Out of code space and cannot flush while compiling %08X.", block->GetPC());
+        return false;
+      }
+    }
+
+    s_code_buffer.WriteProtect(false);
+    Recompiler::CodeGenerator codegen(&s_code_buffer);
+    const bool compile_result = codegen.CompileBlock(block, &block->host_code, &block->host_code_size);
+    s_code_buffer.WriteProtect(true);
+
+    if (!compile_result)
+    {
+      Log_ErrorPrintf("Failed to compile host code for block at 0x%08X", block->key.GetPC());
+      return false;
+    }
+  }
+#endif
+
+  if (!s_block_cache_serial.empty())
+    RecordBlockAnalysis(block);
+
+  return true;
+}
+
+bool AnalyzeBlock(CodeBlock* block)
 {
   u32 pc = block->GetPC();
   bool is_branch_delay_slot = false;
@@ -808,71 +1315,882 @@ bool CompileBlock(CodeBlock* block, bool allow_flush)
     return false;
   }
 
-#ifdef WITH_RECOMPILER
-  if (g_settings.IsUsingRecompiler())
+  return true;
+}
+
+static constexpr u32 MAX_IDLE_LOOP_INSTRUCTIONS = 16;
+
+/// Gets the registers read and written by an instruction which is allowed in an idle loop.
+/// Returns false for anything with side effects, or which depends on state other than registers and memory.
+static bool GetIdleLoopInstructionRegisters(const Instruction& instruction, u32* read_regs, u32* write_regs)
+{
+  const u32 rs = (1u << static_cast<u32>(instruction.i.rs.GetValue()));
+  const u32 rt = (1u << static_cast<u32>(instruction.i.rt.GetValue()));
+  switch (instruction.op)
   {
-    // Ensure we're not going to run out of space while compiling this block.
-    if (s_code_buffer.GetFreeCodeSpace() <
-          (block->instructions.size() * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) ||
-        s_code_buffer.GetFreeFarCodeSpace() <
-          (block->instructions.size() * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION))
+    case InstructionOp::funct:
     {
-      if (allow_flush)
+      const u32 rd = (1u << static_cast<u32>(instruction.r.rd.GetValue()));
+      switch (instruction.r.funct)
       {
-        Log_WarningPrintf("Out of code space, flushing all blocks.");
-        Flush();
+        case InstructionFunct::sll:
+        case InstructionFunct::srl:
+        case InstructionFunct::sra:
+          *read_regs = rt;
+          *write_regs = rd;
+          return true;
+
+        case InstructionFunct::sllv:
+        case InstructionFunct::srlv:
+        case InstructionFunct::srav:
+        case InstructionFunct::addu:
+        case InstructionFunct::subu:
+        case InstructionFunct::and_:
+        case InstructionFunct::or_:
+        case InstructionFunct::xor_:
+        case InstructionFunct::nor:
+        case InstructionFunct::slt:
+        case InstructionFunct::sltu:
+          *read_regs = rs | rt;
+          *write_regs = rd;
+          return true;
+
+        default:
+          return false;
       }
-      else
-      {
-        Log_ErrorPrintf("Out of code space and cannot flush while compiling %08X.", block->GetPC());
+    }
+
+    case InstructionOp::addiu:
+    case InstructionOp::slti:
+    case InstructionOp::sltiu:
+    case InstructionOp::andi:
+    case InstructionOp::ori:
+    case InstructionOp::xori:
+    case InstructionOp::lb:
+    case InstructionOp::lh:
+    case InstructionOp::lw:
+    case InstructionOp::lbu:
+    case InstructionOp::lhu:
+      *read_regs = rs;
+      *write_regs = rt;
+      return true;
+
+    case InstructionOp::lui:
+      *read_regs = 0;
+      *write_regs = rt;
+      return true;
+
+    case InstructionOp::beq:
+    case InstructionOp::bne:
+      *read_regs = rs | rt;
+      *write_regs = 0;
+      return true;
+
+    case InstructionOp::blez:
+    case InstructionOp::bgtz:
+      *read_regs = rs;
+      *write_regs = 0;
+      return true;
+
+    case InstructionOp::b:
+    {
+      // bltzal/bgezal write the link register
+      if ((static_cast<u8>(instruction.i.rt.GetValue()) & u8(0x1E)) == u8(0x10))
         return false;
-      }
+
+      *read_regs = rs;
+      *write_regs = 0;
+      return true;
     }
 
-    s_code_buffer.WriteProtect(false);
-    Recompiler::CodeGenerator codegen(&s_code_buffer);
-    const bool compile_result = codegen.CompileBlock(block, &block->host_code, &block->host_code_size);
-    s_code_buffer.WriteProtect(true);
+    case InstructionOp::j:
+      *read_regs = 0;
+      *write_regs = 0;
+      return true;
 
-    if (!compile_result)
-    {
-      Log_ErrorPrintf("Failed to compile host code for block at 0x%08X", block->key.GetPC());
+    default:
       return false;
-    }
   }
-#endif
-
-  return true;
 }
 
-#ifdef WITH_RECOMPILER
-
-void FastCompileBlockFunction()
+bool IsIdleLoopBlock(const CodeBlock* block)
 {
-  CodeBlock* block = LookupBlock(GetNextBlockKey(), true);
-  if (block)
+  // Block is the body of the loop, ending with the branch back to the start and its delay slot.
+  const u32 count = static_cast<u32>(block->instructions.size());
+  if (count < 2 || count > MAX_IDLE_LOOP_INSTRUCTIONS || block->contains_double_branches)
+    return false;
+
+  const CodeBlockInstruction& branch = block->instructions[count - 2];
+  if (!branch.is_direct_branch_instruction ||
+      GetDirectBranchTarget(branch.instruction, branch.pc) != block->GetPC() ||
+      block->instructions[count - 1].has_load_delay)
   {
-    s_single_block_asm_dispatcher(block->host_code);
-    return;
+    return false;
   }
 
-  if (g_settings.gpu_pgxp_enable)
+  // Every iteration has to compute the same values as the previous one, so registers which are written in the loop
+  // can't be read until they've been written in the current iteration. Load addresses also have to stay the same.
+  u32 loop_written_regs = 0;
+  for (const CodeBlockInstruction& cbi : block->instructions)
   {
-    if (g_settings.gpu_pgxp_cpu)
-      InterpretUncachedBlock<PGXPMode::CPU>();
-    else
-      InterpretUncachedBlock<PGXPMode::Memory>();
+    u32 read_regs, write_regs;
+    if (!GetIdleLoopInstructionRegisters(cbi.instruction, &read_regs, &write_regs))
+      return false;
+
+    loop_written_regs |= write_regs;
   }
-  else
+  loop_written_regs &= ~1u;
+
+  u32 written_regs = 0;
+  u32 load_delay_regs = 0;
+  for (const CodeBlockInstruction& cbi : block->instructions)
   {
-    InterpretUncachedBlock<PGXPMode::Disabled>();
+    u32 read_regs, write_regs;
+    GetIdleLoopInstructionRegisters(cbi.instruction, &read_regs, &write_regs);
+    if ((read_regs & loop_written_regs & ~written_regs) != 0)
+      return false;
+
+    if (cbi.is_load_instruction && (read_regs & loop_written_regs) != 0)
+      return false;
+
+    // loaded values aren't visible until after the load delay slot
+    written_regs |= load_delay_regs;
+    load_delay_regs = cbi.has_load_delay ? write_regs : 0;
+    if (!cbi.has_load_delay)
+      written_regs |= write_regs;
   }
+
+  Log_DevPrintf("Idle loop detected at 0x%08X (%u instructions)", block->GetPC(), count);
+  return true;
 }
 
-void InvalidCodeFunction()
+/// lui rt, hi followed by ori/addiu rt, rt, lo.
+static bool IsFusableConstantLoad(const Instruction& first, const Instruction& second)
 {
-  Log_ErrorPrintf("Trying to execute invalid code at 0x%08X", g_state.pc);
-  if (g_settings.gpu_pgxp_enable)
+  return (first.op == InstructionOp::lui && first.i.rt != Reg::zero &&
+          (second.op == InstructionOp::ori || (second.op == InstructionOp::addiu && second.i.imm != 0)) &&
+          second.i.rs == first.i.rt && second.i.rt == first.i.rt);
+}
+
+/// slt/sltu/slti/sltiu into a register, followed by beq/bne comparing that register against zero.
+static bool IsFusableCompareBranch(const Instruction& first, const Instruction& second)
+{
+  Reg result_reg;
+  if (first.op == InstructionOp::funct &&
+      (first.r.funct == InstructionFunct::slt || first.r.funct == InstructionFunct::sltu))
+  {
+    result_reg = first.r.rd;
+  }
+  else if (first.op == InstructionOp::slti || first.op == InstructionOp::sltiu)
+  {
+    result_reg = first.i.rt;
+  }
+  else
+  {
+    return false;
+  }
+
+  return (result_reg != Reg::zero && (second.op == InstructionOp::beq || second.op == InstructionOp::bne) &&
+          ((second.i.rs == result_reg && second.i.rt == Reg::zero) ||
+           (second.i.rs == Reg::zero && second.i.rt == result_reg)));
+}
+
+/// lb/lbu/lh/lhu/lw followed by a nop in its load delay slot.
+static bool IsFusableLoadNop(const Instruction& first, const Instruction& second)
+{
+  return (second.bits == 0 && (first.op == InstructionOp::lb || first.op == InstructionOp::lbu ||
+                               first.op == InstructionOp::lh || first.op == InstructionOp::lhu ||
+                               first.op == InstructionOp::lw));
+}
+
+/// Returns the number of lw or sw instructions starting at index which access word-aligned offsets from sp, or zero if
+/// there are fewer than two. Loads have to write different registers, other than sp, so the load delay of each one
+/// only matters to the next instruction after the run.
+static u32 GetFusableStackRunLength(const CodeBlock* block, size_t index)
+{
+  static constexpr u32 MAX_LENGTH = std::numeric_limits<u8>::max();
+
+  const InstructionOp op = block->instructions[index].instruction.op;
+  if (op != InstructionOp::lw && op != InstructionOp::sw)
+    return 0;
+
+  u32 loaded_regs = 0;
+  u32 length = 0;
+  for (size_t i = index; i < block->instructions.size() && length < MAX_LENGTH; i++)
+  {
+    const CodeBlockInstruction& cbi = block->instructions[i];
+    const Instruction inst = cbi.instruction;
+    if (cbi.is_branch_delay_slot || inst.op != op || inst.i.rs != Reg::sp || (inst.i.imm_zext32() & 3u) != 0)
+      break;
+
+    if (op == InstructionOp::lw)
+    {
+      const u32 reg_bit = (1u << static_cast<u8>(inst.i.rt.GetValue()));
+      if (inst.i.rt == Reg::zero || inst.i.rt == Reg::sp || (loaded_regs & reg_bit) != 0)
+        break;
+
+      loaded_regs |= reg_bit;
+    }
+
+    length++;
+  }
+
+  return (length >= 2) ? length : 0;
+}
+
+void FuseBlockInstructions(CodeBlock* block)
+{
+  for (CodeBlockInstruction& cbi : block->instructions)
+  {
+    cbi.is_fused_constant_load = false;
+    cbi.is_fused_compare_branch = false;
+    cbi.is_fused_load_nop = false;
+    cbi.fused_stack_run_length = 0;
+  }
+
+  const size_t count = block->instructions.size();
+  for (size_t i = 0; (i + 1) < count; i++)
+  {
+    CodeBlockInstruction& first = block->instructions[i];
+    const CodeBlockInstruction& second = block->instructions[i + 1];
+    if (first.is_branch_delay_slot || first.is_branch_instruction || second.is_branch_delay_slot)
+      continue;
+
+    // The load itself is executed as usual, so this is fine anywhere.
+    if (IsFusableLoadNop(first.instruction, second.instruction))
+    {
+      first.is_fused_load_nop = true;
+      i++;
+      continue;
+    }
+
+    // Other fused instructions skip the load delay update, so they can't start in a load delay slot. The first
+    // instruction is never fused, because the previous block can leave a load delay pending.
+    if (i == 0 || first.is_load_delay_slot)
+      continue;
+
+    if (IsFusableConstantLoad(first.instruction, second.instruction))
+    {
+      first.is_fused_constant_load = true;
+      i++;
+    }
+    else if (IsFusableCompareBranch(first.instruction, second.instruction))
+    {
+      first.is_fused_compare_branch = true;
+      i++;
+    }
+    else if (const u32 run_length = GetFusableStackRunLength(block, i); run_length > 0)
+    {
+      first.fused_stack_run_length = static_cast<u8>(run_length);
+      i += run_length - 1;
+    }
+  }
+}
+
+static u32 PackInstructionFlags(const CodeBlockInstruction& cbi)
+{
+  return (static_cast<u32>(cbi.is_branch_instruction) << 0) |
+         (static_cast<u32>(cbi.is_direct_branch_instruction) << 1) |
+         (static_cast<u32>(cbi.is_unconditional_branch_instruction) << 2) |
+         (static_cast<u32>(cbi.is_branch_delay_slot) << 3) | (static_cast<u32>(cbi.is_load_instruction) << 4) |
+         (static_cast<u32>(cbi.is_store_instruction) << 5) | (static_cast<u32>(cbi.is_load_delay_slot) << 6) |
+         (static_cast<u32>(cbi.is_last_instruction) << 7) | (static_cast<u32>(cbi.has_load_delay) << 8) |
+         (static_cast<u32>(cbi.can_trap) << 9);
+}
+
+static void UnpackInstructionFlags(CodeBlockInstruction* cbi, u32 flags)
+{
+  cbi->is_branch_instruction = ConvertToBoolUnchecked((flags >> 0) & 1);
+  cbi->is_direct_branch_instruction = ConvertToBoolUnchecked((flags >> 1) & 1);
+  cbi->is_unconditional_branch_instruction = ConvertToBoolUnchecked((flags >> 2) & 1);
+  cbi->is_branch_delay_slot = ConvertToBoolUnchecked((flags >> 3) & 1);
+  cbi->is_load_instruction = ConvertToBoolUnchecked((flags >> 4) & 1);
+  cbi->is_store_instruction = ConvertToBoolUnchecked((flags >> 5) & 1);
+  cbi->is_load_delay_slot = ConvertToBoolUnchecked((flags >> 6) & 1);
+  cbi->is_last_instruction = ConvertToBoolUnchecked((flags >> 7) & 1);
+  cbi->has_load_delay = ConvertToBoolUnchecked((flags >> 8) & 1);
+  cbi->can_trap = ConvertToBoolUnchecked((flags >> 9) & 1);
+  cbi->is_trace_join = false;
+  cbi->is_fused_constant_load = false;
+  cbi->is_fused_compare_branch = false;
+  cbi->is_fused_load_nop = false;
+  cbi->fused_stack_run_length = 0;
+}
+
+std::string GetBlockCacheFileName(const std::string_view& serial)
+{
+  return Path::Combine(EmuFolders::Cache, fmt::format("blockcache/{}.cache", Path::SanitizeFileName(serial)));
+}
+
+void SetBlockCacheSerial(const std::string_view& serial)
+{
+  const std::string_view new_serial = g_settings.cpu_recompiler_block_cache ? serial : std::string_view();
+  if (s_block_cache_serial == new_serial)
+    return;
+
+  if (!s_block_cache_serial.empty())
+  {
+    SaveBlockCache();
+    s_block_cache.clear();
+    s_block_cache_dirty = false;
+  }
+
+  s_block_cache_serial = new_serial;
+  if (!s_block_cache_serial.empty())
+    LoadBlockCache();
+}
+
+void LoadBlockCache()
+{
+  const std::string filename(GetBlockCacheFileName(s_block_cache_serial));
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_READ | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+    return;
+
+  u32 signature, version, count;
+  if (!stream->ReadU32(&signature) || !stream->ReadU32(&version) || !stream->ReadU32(&count) ||
+      signature != BLOCK_CACHE_SIGNATURE || version != BLOCK_CACHE_VERSION || count > BLOCK_CACHE_MAX_ENTRIES)
+  {
+    Log_WarningPrintf("Block cache '%s' is invalid or from an older version, ignoring.", filename.c_str());
+    return;
+  }
+
+  s_block_cache.reserve(count);
+  for (u32 i = 0; i < count; i++)
+  {
+    u32 key, num_instructions, num_successors;
+    CachedBlockAnalysis analysis;
+    u8 contains_double_branches;
+    if (!stream->ReadU32(&key) || !stream->ReadU32(&analysis.code_hash) || !stream->ReadU8(&contains_double_branches) ||
+        !stream->ReadU32(&num_instructions) || num_instructions == 0 ||
+        num_instructions > BLOCK_CACHE_MAX_INSTRUCTIONS)
+    {
+      Log_WarningPrintf("Block cache '%s' is corrupted.", filename.c_str());
+      s_block_cache.clear();
+      return;
+    }
+
+    analysis.contains_double_branches = (contains_double_branches != 0);
+    analysis.instructions.resize(num_instructions);
+    for (CodeBlockInstruction& cbi : analysis.instructions)
+    {
+      u32 flags;
+      if (!stream->ReadU32(&cbi.pc) || !stream->ReadU32(&cbi.instruction.bits) || !stream->ReadU32(&flags))
+      {
+        Log_WarningPrintf("Block cache '%s' is corrupted.", filename.c_str());
+        s_block_cache.clear();
+        return;
+      }
+
+      UnpackInstructionFlags(&cbi, flags);
+    }
+
+    if (!stream->ReadU32(&num_successors) || num_successors > BLOCK_CACHE_MAX_SUCCESSORS)
+    {
+      Log_WarningPrintf("Block cache '%s' is corrupted.", filename.c_str());
+      s_block_cache.clear();
+      return;
+    }
+
+    analysis.successors.resize(num_successors);
+    for (u32& successor : analysis.successors)
+    {
+      if (!stream->ReadU32(&successor))
+      {
+        Log_WarningPrintf("Block cache '%s' is corrupted.", filename.c_str());
+        s_block_cache.clear();
+        return;
+      }
+    }
+
+    if (analysis.code_hash != GetInstructionCodeHash(analysis.instructions))
+    {
+      Log_WarningPrintf("Block cache '%s' has a bad hash for block %08X.", filename.c_str(), key);
+      s_block_cache.clear();
+      return;
+    }
+
+    s_block_cache.emplace(key, std::move(analysis));
+  }
+
+  Log_InfoPrintf("Loaded %zu blocks from block cache '%s'.", s_block_cache.size(), filename.c_str());
+}
+
+void SaveBlockCache()
+{
+  if (!s_block_cache_dirty || s_block_cache.empty())
+    return;
+
+  const std::string filename(GetBlockCacheFileName(s_block_cache_serial));
+  if (!FileSystem::EnsureDirectoryExists(std::string(Path::GetDirectory(filename)).c_str(), false))
+  {
+    Log_ErrorPrintf("Failed to create block cache directory for '%s'", filename.c_str());
+    return;
+  }
+
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::OpenFile(filename.c_str(), BYTESTREAM_OPEN_CREATE | BYTESTREAM_OPEN_WRITE | BYTESTREAM_OPEN_TRUNCATE |
+                                             BYTESTREAM_OPEN_ATOMIC_UPDATE | BYTESTREAM_OPEN_STREAMED);
+  if (!stream)
+  {
+    Log_ErrorPrintf("Failed to open block cache '%s' for writing", filename.c_str());
+    return;
+  }
+
+  bool result = stream->WriteU32(BLOCK_CACHE_SIGNATURE);
+  result &= stream->WriteU32(BLOCK_CACHE_VERSION);
+  result &= stream->WriteU32(static_cast<u32>(s_block_cache.size()));
+  for (const auto& [key, analysis] : s_block_cache)
+  {
+    result &= stream->WriteU32(key);
+    result &= stream->WriteU32(analysis.code_hash);
+    result &= stream->WriteU8(static_cast<u8>(analysis.contains_double_branches));
+    result &= stream->WriteU32(static_cast<u32>(analysis.instructions.size()));
+    for (const CodeBlockInstruction& cbi : analysis.instructions)
+    {
+      result &= stream->WriteU32(cbi.pc);
+      result &= stream->WriteU32(cbi.instruction.bits);
+      result &= stream->WriteU32(PackInstructionFlags(cbi));
+    }
+    result &= stream->WriteU32(static_cast<u32>(analysis.successors.size()));
+    for (const u32 successor : analysis.successors)
+      result &= stream->WriteU32(successor);
+  }
+
+  if (!result || !stream->Commit())
+  {
+    Log_ErrorPrintf("Failed to write block cache '%s'", filename.c_str());
+    stream->Discard();
+    return;
+  }
+
+  Log_InfoPrintf("Saved %zu blocks to block cache '%s'.", s_block_cache.size(), filename.c_str());
+  s_block_cache_dirty = false;
+}
+
+u32 GetInstructionCodeHash(const std::vector<CodeBlockInstruction>& instructions)
+{
+  u32 hash = static_cast<u32>(crc32(0, nullptr, 0));
+  for (const CodeBlockInstruction& cbi : instructions)
+    hash = static_cast<u32>(crc32(hash, reinterpret_cast<const Bytef*>(&cbi.instruction.bits), sizeof(u32)));
+  return hash;
+}
+
+bool IsCachedBlockAnalysisValid(const CachedBlockAnalysis& analysis)
+{
+  // Nothing has written to the code since it was last checked?
+  if (analysis.validated_epoch == s_block_cache_epoch)
+  {
+    const u32 start_address = analysis.instructions.front().pc & PHYSICAL_MEMORY_ADDRESS_MASK;
+    if (!Bus::IsRAMAddress(start_address))
+      return true;
+
+    const u32 page_index = Bus::GetRAMCodePageIndex(start_address);
+    if (Bus::IsRAMCodePage(page_index) && s_ram_code_page_write_counts[page_index] == analysis.validated_write_count)
+      return true;
+  }
+
+  // Otherwise compare against memory. The instructions are stored, so there's no need to hash it.
+  for (const CodeBlockInstruction& cbi : analysis.instructions)
+  {
+    u32 bits;
+    if (!SafeReadInstruction(cbi.pc, &bits) || bits != cbi.instruction.bits)
+      return false;
+  }
+
+  return true;
+}
+
+void MarkBlockAnalysisValidated(const CodeBlock* block)
+{
+  // Only blocks in a single page, so there's one count to check.
+  if (block->is_trace || (block->IsInRAM() && block->GetStartPageIndex() != block->GetEndPageIndex()))
+    return;
+
+  // The analysis was just recorded from this block, so it matches memory.
+  const auto iter = s_block_cache.find(block->key.bits);
+  if (iter == s_block_cache.end() || iter->second.instructions.size() != block->instructions.size())
+    return;
+
+  CachedBlockAnalysis& analysis = iter->second;
+  analysis.validated_epoch = s_block_cache_epoch;
+  analysis.validated_write_count = block->IsInRAM() ? s_ram_code_page_write_counts[block->GetStartPageIndex()] : 0;
+}
+
+void BumpRAMCodePageWriteCount(u32 page_index)
+{
+  s_ram_code_page_write_counts[page_index]++;
+}
+
+bool ApplyCachedBlockAnalysis(CodeBlock* block)
+{
+  if (s_block_cache.empty())
+    return false;
+
+  const auto iter = s_block_cache.find(block->key.bits);
+  if (iter == s_block_cache.end() || !IsCachedBlockAnalysisValid(iter->second))
+    return false;
+
+  const CachedBlockAnalysis& analysis = iter->second;
+  block->instructions.clear();
+  block->instructions.reserve(analysis.instructions.size());
+  for (const CodeBlockInstruction& cbi : analysis.instructions)
+    block->instructions.push_back(cbi);
+  block->contains_double_branches = analysis.contains_double_branches;
+
+  // Fetch timing depends on the current memory configuration, so it's not cached.
+  block->icache_line_count = 0;
+  block->uncached_fetch_ticks = 0;
+  block->contains_loadstore_instructions = false;
+
+  u32 last_cache_line = ICACHE_LINES;
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    if (g_settings.cpu_recompiler_icache)
+    {
+      const u32 icache_line = GetICacheLine(cbi.pc);
+      if (icache_line != last_cache_line)
+      {
+        block->icache_line_count++;
+        last_cache_line = icache_line;
+      }
+    }
+
+    block->uncached_fetch_ticks += GetInstructionReadTicks(cbi.pc);
+    block->contains_loadstore_instructions |= (cbi.is_load_instruction || cbi.is_store_instruction);
+  }
+
+  return true;
+}
+
+void RecordBlockAnalysis(const CodeBlock* block)
+{
+  if (block->instructions.size() > BLOCK_CACHE_MAX_INSTRUCTIONS)
+    return;
+
+  auto iter = s_block_cache.find(block->key.bits);
+  if (iter == s_block_cache.end())
+  {
+    if (s_block_cache.size() >= BLOCK_CACHE_MAX_ENTRIES)
+      return;
+
+    iter = s_block_cache.emplace(block->key.bits, CachedBlockAnalysis()).first;
+  }
+
+  CachedBlockAnalysis& analysis = iter->second;
+  const u32 code_hash = GetInstructionCodeHash(block->instructions);
+  if (analysis.code_hash == code_hash && !analysis.instructions.empty())
+    return;
+
+  analysis.code_hash = code_hash;
+  analysis.contains_double_branches = block->contains_double_branches;
+  analysis.validated_epoch = 0;
+  analysis.instructions.clear();
+  analysis.instructions.reserve(block->instructions.size());
+  for (const CodeBlockInstruction& cbi : block->instructions)
+    analysis.instructions.push_back(cbi);
+  analysis.successors.clear();
+  s_block_cache_dirty = true;
+}
+
+void RecordBlockSuccessor(const CodeBlock* from, const CodeBlock* to)
+{
+  const auto iter = s_block_cache.find(from->key.bits);
+  if (iter == s_block_cache.end())
+    return;
+
+  std::vector<u32>& successors = iter->second.successors;
+  if (successors.size() >= BLOCK_CACHE_MAX_SUCCESSORS ||
+      std::find(successors.begin(), successors.end(), to->key.bits) != successors.end())
+  {
+    return;
+  }
+
+  successors.push_back(to->key.bits);
+  s_block_cache_dirty = true;
+}
+
+void QueueCachedSuccessors(const CodeBlock* block)
+{
+  // Only worth doing for the recompiler. Precompiled blocks don't queue their own successors, so it only goes one
+  // level deep from code which has actually run.
+  if (!g_settings.IsUsingRecompiler() || s_block_cache_precompiling)
+    return;
+
+  const auto iter = s_block_cache.find(block->key.bits);
+  if (iter == s_block_cache.end())
+    return;
+
+  for (const u32 successor : iter->second.successors)
+  {
+    if (s_block_cache_precompile_queue.size() >= BLOCK_CACHE_MAX_PRECOMPILE_QUEUE)
+      break;
+
+    if (!s_blocks.Find(successor) && s_block_cache.find(successor) != s_block_cache.end() &&
+        std::find(s_block_cache_precompile_queue.begin(), s_block_cache_precompile_queue.end(), successor) ==
+          s_block_cache_precompile_queue.end())
+    {
+      s_block_cache_precompile_queue.push_back(successor);
+    }
+  }
+}
+
+void PrecompileQueuedSuccessors()
+{
+  if (s_block_cache_precompiling || s_block_cache_precompile_queue.empty())
+    return;
+
+#ifdef WITH_RECOMPILER
+  // With the compile thread running, only the cached analysis is applied here and the host code is generated in the
+  // background, so everything queued so far is handed over at once.
+  const bool compile_in_background = s_compile_thread.joinable();
+#else
+  const bool compile_in_background = false;
+#endif
+
+  // Otherwise, one block per lookup, and a limited number each frame, so there's no hitch when a large area is entered.
+  const u32 frame_number = System::GetFrameNumber();
+  if (s_block_cache_precompile_frame != frame_number)
+  {
+    s_block_cache_precompile_frame = frame_number;
+    s_block_cache_precompile_count = 0;
+  }
+  if (!compile_in_background && s_block_cache_precompile_count >= BLOCK_CACHE_PRECOMPILES_PER_FRAME)
+    return;
+
+  // Lookups queue more successors, bound the work by what was queued on entry.
+  u32 remaining = compile_in_background ? static_cast<u32>(s_block_cache_precompile_queue.size()) : 1;
+  s_block_cache_precompiling = true;
+
+  for (; remaining > 0 && !s_block_cache_precompile_queue.empty(); remaining--)
+  {
+    const u32 successor = s_block_cache_precompile_queue.back();
+    s_block_cache_precompile_queue.pop_back();
+    if (s_blocks.Find(successor))
+      continue;
+
+    const auto iter = s_block_cache.find(successor);
+    if (iter == s_block_cache.end() || !IsCachedBlockAnalysisValid(iter->second))
+      continue;
+
+    s_block_cache_precompile_count++;
+
+    CodeBlockKey key;
+    key.bits = successor;
+    LookupBlock(key, false);
+  }
+
+  s_block_cache_precompiling = false;
+}
+
+#ifdef WITH_RECOMPILER
+
+template<PGXPMode pgxp_mode>
+static void InterpretPendingBlock(const CodeBlock& block)
+{
+  if (g_settings.cpu_recompiler_icache)
+    CheckAndUpdateICacheTags(block.icache_line_count, block.uncached_fetch_ticks);
+
+  InterpretCachedBlock<pgxp_mode>(block);
+}
+
+void FastCompileBlockFunction()
+{
+  // Blocks which have finished compiling in the background stay on this path until they're published.
+  if (s_compile_thread.joinable())
+    PublishCompiledBlocks();
+
+  CodeBlock* block = LookupBlock(GetNextBlockKey(), true);
+  if (block && !block->compile_pending)
+  {
+    s_single_block_asm_dispatcher(block->host_code);
+    return;
+  }
+  else if (block)
+  {
+    if (g_settings.gpu_pgxp_enable)
+    {
+      if (g_settings.gpu_pgxp_cpu)
+        InterpretPendingBlock<PGXPMode::CPU>(*block);
+      else
+        InterpretPendingBlock<PGXPMode::Memory>(*block);
+    }
+    else
+    {
+      InterpretPendingBlock<PGXPMode::Disabled>(*block);
+    }
+
+    return;
+  }
+
+  if (g_settings.gpu_pgxp_enable)
+  {
+    if (g_settings.gpu_pgxp_cpu)
+      InterpretUncachedBlock<PGXPMode::CPU>();
+    else
+      InterpretUncachedBlock<PGXPMode::Memory>();
+  }
+  else
+  {
+    InterpretUncachedBlock<PGXPMode::Disabled>();
+  }
+}
+
+bool EndsWithDirectBranch(const CodeBlock* block)
+{
+  const size_t count = block->instructions.size();
+  return (count >= 2 && block->instructions[count - 2].is_direct_branch_instruction &&
+          block->instructions[count - 1].is_branch_delay_slot && !block->instructions[count - 1].is_branch_instruction);
+}
+
+bool CanStartTrace(const CodeBlock* block)
+{
+  // The icache check at the start of the block assumes its code is contiguous.
+  return (g_settings.cpu_recompiler_traces && g_settings.cpu_recompiler_block_linking &&
+          !g_settings.cpu_recompiler_icache && !block->is_trace && !block->is_idle_loop &&
+          !block->contains_double_branches && block->IsInRAM() && GetSegmentForAddress(block->GetPC()) < Segment::KSEG1 &&
+          EndsWithDirectBranch(block));
+}
+
+bool IsTraceableBlock(const CodeBlock* block)
+{
+  return (block->can_link && !block->invalidated && !block->compile_pending && !block->is_trace &&
+          !block->is_idle_loop && !block->contains_double_branches && block->IsInRAM() &&
+          GetSegmentForAddress(block->GetPC()) < Segment::KSEG1);
+}
+
+void CompileTrace(CodeBlock* head)
+{
+  if (!IsTraceableBlock(head) || !EndsWithDirectBranch(head))
+    return;
+
+  // Follow the most frequently executed successor of each block, until we loop or hit something cold.
+  std::vector<CodeBlock*> members;
+  members.push_back(head);
+  u32 code_start_address = head->code_start_address;
+  u32 code_end_address = head->code_end_address;
+  u32 num_instructions = static_cast<u32>(head->instructions.size());
+  CodeBlock* current = head;
+  while (members.size() < MAX_TRACE_BLOCKS && EndsWithDirectBranch(current))
+  {
+    CodeBlock* next = nullptr;
+    for (const CodeBlock::LinkInfo& li : current->link_successors)
+    {
+      if (!next || li.block->execution_count > next->execution_count)
+        next = li.block;
+    }
+
+    if (!next || std::find(members.begin(), members.end(), next) != members.end() || !IsTraceableBlock(next) ||
+        next->key.user_mode != head->key.user_mode || next->execution_count < (current->execution_count / 2))
+    {
+      break;
+    }
+
+    // Linked successors should always be one of the branch's destinations, but check in case the block was truncated.
+    const CodeBlockInstruction& branch = current->instructions[current->instructions.size() - 2];
+    if (next->GetPC() != GetDirectBranchTarget(branch.instruction, branch.pc) &&
+        next->GetPC() != (branch.pc + static_cast<u32>(sizeof(Instruction) * 2)))
+    {
+      break;
+    }
+
+    const u32 new_code_start_address = std::min(code_start_address, next->code_start_address);
+    const u32 new_code_end_address = std::max(code_end_address, next->code_end_address);
+    const u32 new_num_instructions = num_instructions + static_cast<u32>(next->instructions.size());
+    if ((new_code_end_address - new_code_start_address) > MAX_TRACE_CODE_SPAN ||
+        new_num_instructions > MAX_TRACE_INSTRUCTIONS)
+    {
+      break;
+    }
+
+    members.push_back(next);
+    code_start_address = new_code_start_address;
+    code_end_address = new_code_end_address;
+    num_instructions = new_num_instructions;
+    current = next;
+  }
+
+  // Can't flush here, the block calling us is still executing.
+  if (members.size() < 2 ||
+      s_code_buffer.GetFreeCodeSpace() < (num_instructions * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) ||
+      s_code_buffer.GetFreeFarCodeSpace() < (num_instructions * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION))
+  {
+    return;
+  }
+
+  std::vector<CodeBlockInstruction> instructions;
+  instructions.reserve(num_instructions);
+  bool contains_loadstore_instructions = false;
+  for (size_t i = 0; i < members.size(); i++)
+  {
+    const CodeBlock* member = members[i];
+    const size_t first = instructions.size();
+    for (const CodeBlockInstruction& cbi : member->instructions)
+      instructions.push_back(cbi);
+    contains_loadstore_instructions |= member->contains_loadstore_instructions;
+
+    // The first instruction of the next block follows the previous block's delay slot directly.
+    if (i > 0)
+      instructions[first].is_load_delay_slot = instructions[first - 1].has_load_delay;
+
+    if ((i + 1) < members.size())
+    {
+      instructions[instructions.size() - 2].is_trace_join = true;
+      instructions.back().is_last_instruction = false;
+    }
+  }
+
+  Log_DevPrintf("Compiling trace at 0x%08X with %zu blocks and %u instructions", head->GetPC(), members.size(),
+                num_instructions);
+
+  // Replace the head block in-place, so that the old code is used if compiling fails.
+  RemoveReferencesToBlock(head);
+  std::swap(head->instructions, instructions);
+  std::vector<Recompiler::LoadStoreBackpatchInfo> old_loadstore_backpatch_info;
+  std::swap(head->loadstore_backpatch_info, old_loadstore_backpatch_info);
+  const CodeBlock::HostCodePointer old_host_code = head->host_code;
+  const u32 old_host_code_size = head->host_code_size;
+  const u32 old_code_start_address = head->code_start_address;
+  const u32 old_code_end_address = head->code_end_address;
+  const bool old_contains_loadstore_instructions = head->contains_loadstore_instructions;
+  head->is_trace = true;
+  head->code_start_address = code_start_address;
+  head->code_end_address = code_end_address;
+  head->contains_loadstore_instructions = contains_loadstore_instructions;
+
+  s_code_buffer.WriteProtect(false);
+  Recompiler::CodeGenerator codegen(&s_code_buffer);
+  const bool compile_result = codegen.CompileBlock(head, &head->host_code, &head->host_code_size);
+  s_code_buffer.WriteProtect(true);
+
+  if (compile_result)
+  {
+    s_statistics.traces_compiled++;
+  }
+  else
+  {
+    Log_WarningPrintf("Failed to compile trace at 0x%08X, keeping the original block.", head->GetPC());
+    std::swap(head->instructions, instructions);
+    std::swap(head->loadstore_backpatch_info, old_loadstore_backpatch_info);
+    head->host_code = old_host_code;
+    head->host_code_size = old_host_code_size;
+    head->code_start_address = old_code_start_address;
+    head->code_end_address = old_code_end_address;
+    head->contains_loadstore_instructions = old_contains_loadstore_instructions;
+    head->is_trace = false;
+  }
+
+  AddBlockToPageMap(head);
+  SetFastMap(head->GetPC(), head->host_code);
+  AddBlockToHostCodeMap(head);
+  s_blocks.Insert(head->key.bits, head);
+}
+
+void InvalidCodeFunction()
+{
+  Log_ErrorPrintf("Trying to execute invalid code at 0x%08X", g_state.pc);
+  if (g_settings.gpu_pgxp_enable)
   {
     if (g_settings.gpu_pgxp_cpu)
       InterpretUncachedBlock<PGXPMode::CPU>();
@@ -892,6 +2210,7 @@ static void InvalidateBlock(CodeBlock* block, bool allow_frame_invalidation)
   // Invalidate forces the block to be checked again.
   Log_DebugPrintf("Invalidating block at 0x%08X", block->GetPC());
   block->invalidated = true;
+  s_statistics.blocks_invalidated++;
 
   if (block->can_link)
   {
@@ -929,31 +2248,132 @@ void InvalidateBlocksWithPageIndex(u32 page_index)
   DebugAssert(page_index < Bus::RAM_8MB_CODE_PAGE_COUNT);
   auto& blocks = m_ram_block_map[page_index];
   for (CodeBlock* block : blocks)
+  {
     InvalidateBlock(block, true);
+    RemoveInvalidatedBlockFromOtherPages(block, page_index);
+  }
 
   // Block will be re-added next execution.
   blocks.clear();
+  s_ram_code_subpage_masks[page_index] = 0;
   Bus::ClearRAMCodePage(page_index);
+  BumpRAMCodePageWriteCount(page_index);
 }
 
-void InvalidateAll()
+void InvalidateBlocksInRange(u32 page_index, PhysicalMemoryAddress start_address, PhysicalMemoryAddress end_address)
+{
+  DebugAssert(page_index < Bus::RAM_8MB_CODE_PAGE_COUNT);
+  if ((s_ram_code_subpage_masks[page_index] & GetSubPageMask(page_index, start_address, end_address)) == 0)
+    return;
+
+  BumpRAMCodePageWriteCount(page_index);
+
+  auto& blocks = m_ram_block_map[page_index];
+  for (auto iter = blocks.begin(); iter != blocks.end();)
+  {
+    CodeBlock* block = *iter;
+    if (block->code_start_address >= end_address || start_address >= block->code_end_address)
+    {
+      ++iter;
+      continue;
+    }
+
+    InvalidateBlock(block, true);
+    RemoveInvalidatedBlockFromOtherPages(block, page_index);
+    iter = blocks.erase(iter);
+  }
+
+  if (blocks.empty())
+  {
+    s_ram_code_subpage_masks[page_index] = 0;
+    Bus::ClearRAMCodePage(page_index);
+  }
+  else
+  {
+    UpdateSubPageMask(page_index);
+  }
+}
+
+void InvalidateBlocksWithAddress(u32 page_index, PhysicalMemoryAddress address)
 {
-  for (auto& it : s_blocks)
+  // Instructions are word aligned, so a smaller write still hits the whole instruction.
+  const PhysicalMemoryAddress word_address = address & ~static_cast<PhysicalMemoryAddress>(sizeof(u32) - 1);
+  InvalidateBlocksInRange(page_index, word_address, word_address + sizeof(u32));
+}
+
+u64 GetSubPageMask(u32 page_index, u32 start_address, u32 end_address)
+{
+  const u32 page_start = page_index * HOST_PAGE_SIZE;
+  start_address = std::max(start_address, page_start);
+  end_address = std::min(end_address, page_start + static_cast<u32>(HOST_PAGE_SIZE));
+  if (start_address >= end_address)
+    return 0;
+
+  const u32 first = (start_address - page_start) / CODE_SUBPAGE_SIZE;
+  const u32 last = (end_address - 1 - page_start) / CODE_SUBPAGE_SIZE;
+  const u64 upper_mask = (last == 63) ? ~UINT64_C(0) : ((UINT64_C(1) << (last + 1)) - 1);
+  return upper_mask & ~((UINT64_C(1) << first) - 1);
+}
+
+#ifdef WITH_MMAP_FASTMEM
+
+bool IsCodeSubPageAddress(PhysicalMemoryAddress address)
+{
+  const u32 page_index = address / HOST_PAGE_SIZE;
+  return (s_ram_code_subpage_masks[page_index] & GetSubPageMask(page_index, address, address + 1)) != 0;
+}
+
+#endif
+
+void UpdateSubPageMask(u32 page_index)
+{
+  u64 mask = 0;
+  for (const CodeBlock* block : m_ram_block_map[page_index])
   {
-    CodeBlock* block = it.second;
+    mask |= GetSubPageMask(page_index, block->code_start_address, block->code_end_address);
+  }
+
+  s_ram_code_subpage_masks[page_index] = mask;
+}
+
+void RemoveInvalidatedBlockFromOtherPages(CodeBlock* block, u32 page_index)
+{
+  // Invalidated blocks aren't in any page, otherwise revalidating would add them twice.
+  const u32 start_page = block->GetStartPageIndex();
+  const u32 end_page = block->GetEndPageIndex();
+  for (u32 page = start_page; page <= end_page; page++)
+  {
+    if (page == page_index)
+      continue;
+
+    auto& page_blocks = m_ram_block_map[page];
+    auto page_block_iter = std::find(page_blocks.begin(), page_blocks.end(), block);
+    if (page_block_iter != page_blocks.end())
+      page_blocks.erase(page_block_iter);
+  }
+}
+
+void InvalidateAll()
+{
+  s_blocks.ForEach([](CodeBlock* block) {
     if (block && !block->invalidated)
       InvalidateBlock(block, false);
-  }
+  });
 
+  // RAM can be replaced without going through the write tracking (e.g. loading a state), so nothing validated
+  // before this can be trusted.
   Bus::ClearRAMCodePageFlags();
   for (auto& it : m_ram_block_map)
     it.clear();
+  s_ram_code_subpage_masks.fill(0);
+  s_block_cache_epoch++;
+  s_block_cache_precompile_queue.clear();
 }
 
 void RemoveReferencesToBlock(CodeBlock* block)
 {
-  BlockMap::iterator iter = s_blocks.find(block->key.GetPC());
-  Assert(iter != s_blocks.end() && iter->second == block);
+  CodeBlock** block_ptr = s_blocks.Find(block->key.bits);
+  Assert(block_ptr && *block_ptr == block);
 
 #ifdef WITH_RECOMPILER
   SetFastMap(block->GetPC(), FastCompileBlockFunction);
@@ -969,7 +2389,7 @@ void RemoveReferencesToBlock(CodeBlock* block)
     RemoveBlockFromHostCodeMap(block);
 #endif
 
-  s_blocks.erase(iter);
+  s_blocks.Remove(block->key.bits);
 }
 
 void AddBlockToPageMap(CodeBlock* block)
@@ -982,6 +2402,7 @@ void AddBlockToPageMap(CodeBlock* block)
   for (u32 page = start_page; page <= end_page; page++)
   {
     m_ram_block_map[page].push_back(block);
+    s_ram_code_subpage_masks[page] |= GetSubPageMask(page, block->code_start_address, block->code_end_address);
     Bus::SetRAMCodePage(page);
   }
 }
@@ -1016,6 +2437,9 @@ void LinkBlock(CodeBlock* from, CodeBlock* to, void* host_pc, void* host_resolve
   li.block = from;
   to->link_predecessors.push_back(li);
 
+  if (!s_block_cache_serial.empty())
+    RecordBlockSuccessor(from, to);
+
 #ifdef WITH_RECOMPILER
   // apply in code
   if (host_pc)
@@ -1091,8 +2515,19 @@ void AddBlockToHostCodeMap(CodeBlock* block)
   if (!g_settings.IsUsingRecompiler())
     return;
 
-  auto ir = s_host_code_map.emplace(block->host_code, block);
-  Assert(ir.second);
+  const uintptr_t start = reinterpret_cast<uintptr_t>(block->host_code);
+  const HostCodeRange range = {start, start + block->host_code_size, block};
+  if (s_host_code_map.empty() || s_host_code_map.back().start < start)
+  {
+    s_host_code_map.push_back(range);
+    return;
+  }
+
+  HostCodeMap::iterator iter = std::lower_bound(
+    s_host_code_map.begin(), s_host_code_map.end(), start,
+    [](const HostCodeRange& lhs, uintptr_t rhs) { return lhs.start < rhs; });
+  Assert(iter == s_host_code_map.end() || iter->start != start);
+  s_host_code_map.insert(iter, range);
 }
 
 void RemoveBlockFromHostCodeMap(CodeBlock* block)
@@ -1100,9 +2535,200 @@ void RemoveBlockFromHostCodeMap(CodeBlock* block)
   if (!g_settings.IsUsingRecompiler())
     return;
 
-  HostCodeMap::iterator hc_iter = s_host_code_map.find(block->host_code);
-  Assert(hc_iter != s_host_code_map.end());
-  s_host_code_map.erase(hc_iter);
+  const uintptr_t start = reinterpret_cast<uintptr_t>(block->host_code);
+  HostCodeMap::iterator iter = std::lower_bound(
+    s_host_code_map.begin(), s_host_code_map.end(), start,
+    [](const HostCodeRange& lhs, uintptr_t rhs) { return lhs.start < rhs; });
+  Assert(iter != s_host_code_map.end() && iter->start == start && iter->block == block);
+  s_host_code_map.erase(iter);
+}
+
+CodeBlock* LookupBlockByHostPC(const void* host_pc)
+{
+  // find the first block which starts after the pc, the one before it (hopefully) contains it
+  const uintptr_t pc = reinterpret_cast<uintptr_t>(host_pc);
+  HostCodeMap::const_iterator iter =
+    std::upper_bound(s_host_code_map.cbegin(), s_host_code_map.cend(), pc,
+                     [](uintptr_t lhs, const HostCodeRange& rhs) { return lhs < rhs.start; });
+  if (iter == s_host_code_map.cbegin())
+    return nullptr;
+
+  --iter;
+  return (pc < iter->end) ? iter->block : nullptr;
+}
+
+void StartCompileThread()
+{
+  if (!SplitAsyncCodeBuffer())
+  {
+    Log_ErrorPrintf("Failed to split code buffer, compiling blocks on the CPU thread.");
+    return;
+  }
+
+  Log_DevPrintf("Starting recompiler compile thread");
+  s_compile_thread_shutdown = false;
+  s_compile_thread = std::thread(&CompileThreadEntryPoint);
+}
+
+void StopCompileThread()
+{
+  if (!s_compile_thread.joinable())
+    return;
+
+  CancelQueuedCompiles();
+
+  {
+    std::unique_lock<std::mutex> lock(s_compile_mutex);
+    s_compile_thread_shutdown = true;
+    s_compile_work_cv.notify_one();
+  }
+
+  s_compile_thread.join();
+  Log_DevPrintf("Recompiler compile thread stopped");
+}
+
+void CompileThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("CPU Recompiler");
+
+  std::unique_lock<std::mutex> lock(s_compile_mutex);
+  for (;;)
+  {
+    s_compile_work_cv.wait(lock, []() {
+      return s_compile_thread_shutdown || (!s_compile_queue.empty() && !s_compile_thread_out_of_space);
+    });
+    if (s_compile_thread_shutdown)
+      break;
+
+    const AsyncCompileJob job = s_compile_queue.front();
+    const u32 num_instructions = static_cast<u32>(job.block->instructions.size());
+    const bool has_space =
+      (s_async_code_buffer.GetFreeCodeSpace() >= (num_instructions * Recompiler::MAX_NEAR_HOST_BYTES_PER_INSTRUCTION) &&
+       s_async_code_buffer.GetFreeFarCodeSpace() >= (num_instructions * Recompiler::MAX_FAR_HOST_BYTES_PER_INSTRUCTION));
+    if (!has_space && s_async_code_buffer.GetTotalUsed() > 0)
+    {
+      // Wait for the CPU thread to give us another chunk, or flush everything if there's none left.
+      s_compile_thread_out_of_space = true;
+      s_compile_results_ready.store(true, std::memory_order_release);
+      continue;
+    }
+
+    s_compile_queue.pop_front();
+    s_compile_thread_busy = true;
+    lock.unlock();
+
+    // Blocks too large for a whole chunk are left to the interpreter.
+    AsyncCompileResult result = {job.block, nullptr, 0};
+    if (has_space)
+    {
+      s_async_code_buffer.WriteProtect(false);
+      Recompiler::CodeGenerator codegen(&s_async_code_buffer);
+      codegen.SetSpeculativeInitialState(&job.regs, job.cop0_sr);
+      if (!codegen.CompileBlock(job.block, &result.host_code, &result.host_code_size))
+        result.host_code = nullptr;
+      s_async_code_buffer.WriteProtect(true);
+    }
+
+    lock.lock();
+    s_compile_results.push_back(result);
+    s_compile_results_ready.store(true, std::memory_order_release);
+    s_compile_thread_busy = false;
+    s_compile_done_cv.notify_one();
+  }
+}
+
+bool QueueCompileBlock(CodeBlock* block)
+{
+  if (!PrepareBlockForCompile(block))
+    return false;
+
+  if (!s_block_cache_serial.empty())
+    RecordBlockAnalysis(block);
+
+  // The compile thread can't look at the CPU state, it'll have moved on by the time the block is compiled.
+  block->compile_pending = true;
+  {
+    std::unique_lock<std::mutex> lock(s_compile_mutex);
+    s_compile_queue.push_back(AsyncCompileJob{block, g_state.regs, g_state.cop0_regs.sr.bits});
+  }
+  s_compile_work_cv.notify_one();
+  return true;
+}
+
+void CancelQueuedCompiles()
+{
+  std::unique_lock<std::mutex> lock(s_compile_mutex);
+  s_compile_queue.clear();
+  s_compile_done_cv.wait(lock, []() { return !s_compile_thread_busy; });
+  s_compile_results.clear();
+  s_compile_results_to_publish.clear();
+  s_compile_results_ready.store(false, std::memory_order_relaxed);
+}
+
+bool SplitAsyncCodeBuffer()
+{
+  if (!s_code_buffer.Split(&s_async_code_buffer, RECOMPILER_ASYNC_CODE_CHUNK_SIZE,
+                           RECOMPILER_ASYNC_FAR_CODE_CHUNK_SIZE))
+  {
+    return false;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(s_compile_mutex);
+    s_compile_thread_out_of_space = false;
+  }
+  s_compile_work_cv.notify_one();
+  return true;
+}
+
+void PublishCompiledBlocks()
+{
+  if (!s_compile_results_ready.load(std::memory_order_acquire))
+    return;
+
+  bool out_of_space;
+  {
+    std::unique_lock<std::mutex> lock(s_compile_mutex);
+    s_compile_results_to_publish.swap(s_compile_results);
+    s_compile_results_ready.store(false, std::memory_order_relaxed);
+    out_of_space = s_compile_thread_out_of_space;
+  }
+
+  for (const AsyncCompileResult& result : s_compile_results_to_publish)
+  {
+    CodeBlock* block = result.block;
+    block->compile_pending = false;
+    if (!result.host_code)
+    {
+      Log_ErrorPrintf("Failed to compile host code for block at 0x%08X", block->key.GetPC());
+
+      // The block was never added to the host code map, so RemoveReferencesToBlock() can't be used here.
+      SetFastMap(block->GetPC(), FastCompileBlockFunction);
+      if (!block->invalidated)
+        RemoveBlockFromPageMap(block);
+      UnlinkBlock(block);
+      s_blocks.Remove(block->key.bits);
+      FallbackExistingBlockToInterpreter(block);
+      continue;
+    }
+
+    // If the block was written to while it was compiling, it stays invalidated and gets revalidated on the next
+    // lookup, just like any other invalidated block.
+    block->host_code = result.host_code;
+    block->host_code_size = result.host_code_size;
+    AddBlockToHostCodeMap(block);
+    if (!block->invalidated)
+      SetFastMap(block->GetPC(), block->host_code);
+  }
+
+  s_compile_results_to_publish.clear();
+
+  // The compile thread is waiting for more space, which is only taken from the code buffer on this thread.
+  if (out_of_space && !SplitAsyncCodeBuffer())
+  {
+    Log_WarningPrintf("Out of code space, flushing all blocks.");
+    Flush();
+  }
 }
 
 bool InitializeFastmem()
@@ -1152,17 +2778,11 @@ Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* exception_pc,
   Log_DevPrintf("Page fault handler invoked at PC=%p Address=%p %s, fastmem offset 0x%08X", exception_pc, fault_address,
                 is_write ? "(write)" : "(read)", fastmem_address);
 
-  // use upper_bound to find the next block after the pc
-  HostCodeMap::iterator upper_iter =
-    s_host_code_map.upper_bound(reinterpret_cast<CodeBlock::HostCodePointer>(exception_pc));
-  if (upper_iter == s_host_code_map.begin())
+  CodeBlock* block = LookupBlockByHostPC(exception_pc);
+  if (!block)
     return Common::PageFaultHandler::HandlerResult::ExecuteNextHandler;
 
-  // then decrement it by one to (hopefully) get the block we want
-  upper_iter--;
-
   // find the loadstore info in the code block
-  CodeBlock* block = upper_iter->second;
   for (auto bpi_iter = block->loadstore_backpatch_info.begin(); bpi_iter != block->loadstore_backpatch_info.end();
        ++bpi_iter)
   {
@@ -1175,7 +2795,14 @@ Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* exception_pc,
         const u32 code_page_index = Bus::GetRAMCodePageIndex(fastmem_address);
         if (Bus::IsRAMCodePage(code_page_index))
         {
-          if (++lbi.fault_count < CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM)
+          // Writes to data next to code go through slowmem, which only invalidates blocks that are overwritten,
+          // instead of unprotecting the page and throwing away every block in it.
+          if (!IsCodeSubPageAddress(fastmem_address & Bus::g_ram_mask))
+          {
+            Log_DevPrintf("Backpatching data write at %p (%08X) address %p (%08X) in code page to slowmem",
+                          exception_pc, lbi.guest_pc, fault_address, fastmem_address);
+          }
+          else if (++lbi.fault_count < CODE_WRITE_FAULT_THRESHOLD_FOR_SLOWMEM)
           {
             InvalidateBlocksWithPageIndex(code_page_index);
             return Common::PageFaultHandler::HandlerResult::ContinueExecution;
@@ -1215,17 +2842,11 @@ Common::PageFaultHandler::HandlerResult MMapPageFaultHandler(void* exception_pc,
 
 Common::PageFaultHandler::HandlerResult LUTPageFaultHandler(void* exception_pc, void* fault_address, bool is_write)
 {
-  // use upper_bound to find the next block after the pc
-  HostCodeMap::iterator upper_iter =
-    s_host_code_map.upper_bound(reinterpret_cast<CodeBlock::HostCodePointer>(exception_pc));
-  if (upper_iter == s_host_code_map.begin())
+  CodeBlock* block = LookupBlockByHostPC(exception_pc);
+  if (!block)
     return Common::PageFaultHandler::HandlerResult::ExecuteNextHandler;
 
-  // then decrement it by one to (hopefully) get the block we want
-  upper_iter--;
-
   // find the loadstore info in the code block
-  CodeBlock* block = upper_iter->second;
   for (auto bpi_iter = block->loadstore_backpatch_info.begin(); bpi_iter != block->loadstore_backpatch_info.end();
        ++bpi_iter)
   {
@@ -1267,7 +2888,12 @@ void CPU::Recompiler::Thunks::ResolveBranch(CodeBlock* block, void* host_pc, voi
 
   CodeBlockKey key = GetNextBlockKey();
   CodeBlock* successor_block = LookupBlock(key, false);
-  if (!successor_block || (successor_block->invalidated && !RevalidateBlock(successor_block, false)) ||
+  if (successor_block && successor_block->compile_pending)
+  {
+    // Not compiled yet, leave it pointing at the resolver so we try again next time.
+    return;
+  }
+  else if (!successor_block || (successor_block->invalidated && !RevalidateBlock(successor_block, false)) ||
       !block->can_link || !successor_block->can_link)
   {
     // just turn it into a return to the dispatcher instead.
@@ -1282,6 +2908,54 @@ void CPU::Recompiler::Thunks::ResolveBranch(CodeBlock* block, void* host_pc, voi
   }
 }
 
+static bool CanSkipIdleLoopRead(VirtualMemoryAddress address)
+{
+  // Only RAM, the scratchpad and the interrupt controller are safe to read without running the loop.
+  // Other I/O registers either have side effects on read, or change over time (e.g. timers, GPUSTAT).
+  const PhysicalMemoryAddress phys_address = address & CPU::PHYSICAL_MEMORY_ADDRESS_MASK;
+  if (CPU::GetSegmentForAddress(address) != CPU::Segment::KSEG2 && Bus::IsRAMAddress(phys_address))
+    return true;
+  else if (CPU::GetSegmentForAddress(address) <= CPU::Segment::KSEG0 &&
+           (address & CPU::DCACHE_LOCATION_MASK) == CPU::DCACHE_LOCATION)
+    return true;
+  else if (phys_address >= Bus::INTERRUPT_CONTROLLER_BASE && phys_address < (Bus::INTERRUPT_CONTROLLER_BASE + 8))
+    return true;
+  else
+    return false;
+}
+
+TickCount CPU::Recompiler::Thunks::SkipIdleLoop(CodeBlock* block)
+{
+  // Skipping is only exact if each iteration takes the same time, so wait until two consecutive iterations agree.
+  const u32 timestamp = TimingEvents::GetGlobalTickCounter() + static_cast<u32>(g_state.pending_ticks);
+  const TickCount iteration_ticks = static_cast<TickCount>(timestamp - block->idle_loop_last_timestamp);
+  const bool stable = (iteration_ticks == block->idle_loop_iteration_ticks);
+  block->idle_loop_last_timestamp = timestamp;
+  block->idle_loop_iteration_ticks = iteration_ticks;
+  if (!stable || iteration_ticks <= 0 || g_state.pending_ticks >= g_state.downcount || g_state.cop0_regs.sr.Isc)
+    return g_state.pending_ticks;
+
+  // Registers are flushed at this point, and load addresses can't change between iterations.
+  for (const CodeBlockInstruction& cbi : block->instructions)
+  {
+    if (cbi.is_load_instruction && !CanSkipIdleLoopRead(*GetLoadStoreEffectiveAddress(cbi.instruction, &g_state.regs)))
+      return g_state.pending_ticks;
+  }
+
+  // Nothing can change what the loop reads until the next event runs, so fast forward by however many iterations
+  // would have executed before then. The loop then exits to the dispatcher as it would have normally.
+  const TickCount remaining_ticks = g_state.downcount - g_state.pending_ticks;
+  const TickCount skip_ticks = ((remaining_ticks + iteration_ticks - 1) / iteration_ticks) * iteration_ticks;
+  g_state.pending_ticks += skip_ticks;
+  block->idle_loop_last_timestamp += static_cast<u32>(skip_ticks);
+  return g_state.pending_ticks;
+}
+
+void CPU::Recompiler::Thunks::CompileTrace(CodeBlock* block)
+{
+  CPU::CodeCache::CompileTrace(block);
+}
+
 void CPU::Recompiler::Thunks::LogPC(u32 pc)
 {
 #if 1
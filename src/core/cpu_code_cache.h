@@ -10,6 +10,7 @@
 #include <array>
 #include <map>
 #include <memory>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -57,6 +58,15 @@ struct CodeBlockInstruction
   bool is_last_instruction : 1;
   bool has_load_delay : 1;
   bool can_trap : 1;
+  bool is_trace_join : 1;
+
+  // Set on the first instruction of a pair which the cached interpreter executes as a single unit.
+  bool is_fused_constant_load : 1;
+  bool is_fused_compare_branch : 1;
+  bool is_fused_load_nop : 1;
+
+  // Number of sp-relative lw or sw instructions starting here which the cached interpreter can execute together.
+  u8 fused_stack_run_length;
 };
 
 struct CodeBlock
@@ -71,9 +81,10 @@ struct CodeBlock
     u32 host_pc_size;
   };
 
+  CodeBlock() = default;
   CodeBlock(const CodeBlockKey key_) : key(key_) {}
 
-  CodeBlockKey key;
+  CodeBlockKey key = {};
   u32 host_code_size = 0;
   HostCodePointer host_code = nullptr;
 
@@ -92,15 +103,29 @@ struct CodeBlock
   bool contains_double_branches = false;
   bool invalidated = false;
   bool can_link = true;
+  bool is_idle_loop = false;
+  bool compile_pending = false;
+  bool is_trace = false;
 
   u32 recompile_frame_number = 0;
   u32 recompile_count = 0;
   u32 invalidate_frame_number = 0;
 
+  // Number of times the block has been entered, used to find hot paths for traces.
+  u32 execution_count = 0;
+
+  // Physical address range of the block's code. Traces can contain code from before their start PC.
+  u32 code_start_address = 0;
+  u32 code_end_address = 0;
+
+  // Timestamp and cost of the last iteration, used to skip idle loops.
+  u32 idle_loop_last_timestamp = 0;
+  TickCount idle_loop_iteration_ticks = 0;
+
   u32 GetPC() const { return key.GetPC(); }
   u32 GetSizeInBytes() const { return static_cast<u32>(instructions.size()) * sizeof(Instruction); }
-  u32 GetStartPageIndex() const { return (key.GetPCPhysicalAddress() / HOST_PAGE_SIZE); }
-  u32 GetEndPageIndex() const { return ((key.GetPCPhysicalAddress() + GetSizeInBytes()) / HOST_PAGE_SIZE); }
+  u32 GetStartPageIndex() const { return (code_start_address / HOST_PAGE_SIZE); }
+  u32 GetEndPageIndex() const { return (code_end_address / HOST_PAGE_SIZE); }
   bool IsInRAM() const
   {
     // TODO: Constant
@@ -119,6 +144,20 @@ enum : u32
 
 using FastMapTable = CodeBlock::HostCodePointer*;
 
+/// Number of executions before a block is replaced by a trace following its hottest successors.
+static constexpr u32 TRACE_EXECUTION_THRESHOLD = 1000;
+
+/// Counters for profiling and benchmarking. Reset when the code cache is initialized.
+struct Statistics
+{
+  u32 blocks_compiled;
+  u32 blocks_recompiled;
+  u32 blocks_invalidated;
+  u32 interpreter_fallbacks;
+  u32 flushes;
+  u32 traces_compiled;
+};
+
 void Initialize();
 void Shutdown();
 [[noreturn]] void Execute();
@@ -128,6 +167,9 @@ using DispatcherFunction = void (*)();
 using SingleBlockDispatcherFunction = void (*)(const CodeBlock::HostCodePointer);
 
 FastMapTable* GetFastMapPointer();
+
+/// Returns true if the block should count its executions, so that it can be turned into a trace once it's hot.
+bool CanStartTrace(const CodeBlock* block);
 #endif
 
 #if defined(WITH_RECOMPILER)
@@ -137,30 +179,43 @@ JitCodeBuffer& GetCodeBuffer();
 /// Flushes the code cache, forcing all blocks to be recompiled.
 void Flush();
 
+/// Returns the compilation/invalidation counters since the code cache was initialized.
+const Statistics& GetStatistics();
+
 /// Changes whether the recompiler is enabled.
 void Reinitialize();
 
 /// Invalidates all blocks which are in the range of the specified code page.
 void InvalidateBlocksWithPageIndex(u32 page_index);
 
+/// Invalidates blocks in the specified code page which overlap the RAM range. Other blocks in the page stay valid.
+void InvalidateBlocksInRange(u32 page_index, PhysicalMemoryAddress start_address, PhysicalMemoryAddress end_address);
+
+/// Invalidates the block(s) containing the instruction at the specified RAM address.
+void InvalidateBlocksWithAddress(u32 page_index, PhysicalMemoryAddress address);
+
 /// Invalidates all blocks in the cache.
 void InvalidateAll();
 
+/// Sets the game serial used for the persistent block analysis cache, saving any analysis for the previous game.
+void SetBlockCacheSerial(const std::string_view& serial);
+
 template<PGXPMode pgxp_mode>
 void InterpretCachedBlock(const CodeBlock& block);
 
 template<PGXPMode pgxp_mode>
 void InterpretUncachedBlock();
 
-/// Invalidates any code pages which overlap the specified range.
+/// Invalidates any blocks in code pages which overlap the specified range.
 ALWAYS_INLINE void InvalidateCodePages(PhysicalMemoryAddress address, u32 word_count)
 {
+  const u32 end_address = address + word_count * static_cast<u32>(sizeof(u32));
   const u32 start_page = address / HOST_PAGE_SIZE;
-  const u32 end_page = (address + word_count * sizeof(u32) - sizeof(u32)) / HOST_PAGE_SIZE;
+  const u32 end_page = (end_address - sizeof(u32)) / HOST_PAGE_SIZE;
   for (u32 page = start_page; page <= end_page; page++)
   {
     if (Bus::m_ram_code_bits[page])
-      CPU::CodeCache::InvalidateBlocksWithPageIndex(page);
+      CPU::CodeCache::InvalidateBlocksInRange(page, address, end_address);
   }
 }
 
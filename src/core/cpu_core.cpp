@@ -2143,6 +2143,175 @@ void SingleStep()
 
 namespace CodeCache {
 
+/// Executes lui followed by ori/addiu to the same register. Neither instruction can raise an exception or has a load
+/// delay, and the block analysis ensures there isn't one pending, so only the register and PC need updating.
+ALWAYS_INLINE_RELEASE static void ExecuteFusedConstantLoad(const CodeBlockInstruction& lui,
+                                                          const CodeBlockInstruction& lo)
+{
+  const u32 hi_value = lui.instruction.i.imm_zext32() << 16;
+  const u32 value = (lo.instruction.op == InstructionOp::ori) ? (hi_value | lo.instruction.i.imm_zext32()) :
+                                                                (hi_value + lo.instruction.i.imm_sext32());
+  g_state.pending_ticks += 2;
+  g_state.pc = g_state.npc + 4;
+  g_state.npc += 8;
+  WriteReg(lui.instruction.i.rt, value);
+}
+
+/// Executes a set-less-than followed by beq/bne on its result, without dispatching the branch separately.
+ALWAYS_INLINE_RELEASE static void ExecuteFusedCompareBranch(const CodeBlockInstruction& compare,
+                                                           const CodeBlockInstruction& branch)
+{
+  const Instruction inst = compare.instruction;
+  Reg result_reg;
+  u32 result;
+  switch (inst.op)
+  {
+    case InstructionOp::funct:
+    {
+      result_reg = inst.r.rd;
+      result = (inst.r.funct == InstructionFunct::slt) ?
+                 BoolToUInt32(static_cast<s32>(ReadReg(inst.r.rs)) < static_cast<s32>(ReadReg(inst.r.rt))) :
+                 BoolToUInt32(ReadReg(inst.r.rs) < ReadReg(inst.r.rt));
+    }
+    break;
+
+    case InstructionOp::slti:
+    {
+      result_reg = inst.i.rt;
+      result = BoolToUInt32(static_cast<s32>(ReadReg(inst.i.rs)) < static_cast<s32>(inst.i.imm_sext32()));
+    }
+    break;
+
+    case InstructionOp::sltiu:
+    default:
+    {
+      result_reg = inst.i.rt;
+      result = BoolToUInt32(ReadReg(inst.i.rs) < inst.i.imm_sext32());
+    }
+    break;
+  }
+
+  WriteReg(result_reg, result);
+  g_state.pending_ticks += 2;
+
+  // now executing the branch
+  g_state.current_instruction.bits = branch.instruction.bits;
+  g_state.current_instruction_pc = branch.pc;
+  g_state.pc = g_state.npc + 4;
+  g_state.npc += 8;
+  g_state.next_instruction_is_branch_delay_slot = true;
+  if ((result != 0) == (branch.instruction.op == InstructionOp::bne))
+    Branch(g_state.pc + (branch.instruction.i.imm_sext32() << 2));
+}
+
+/// Executes a load followed by a nop in its load delay slot. The load is executed as usual, so exceptions are still
+/// precise, and the nop only has to advance the PC and let the load delay complete. Returns false on an exception.
+template<PGXPMode pgxp_mode>
+ALWAYS_INLINE_RELEASE static bool ExecuteFusedLoadNop(const CodeBlockInstruction& load)
+{
+  g_state.pending_ticks++;
+  g_state.current_instruction.bits = load.instruction.bits;
+  g_state.current_instruction_pc = load.pc;
+  g_state.current_instruction_in_branch_delay_slot = false;
+  g_state.current_instruction_was_branch_taken = g_state.branch_was_taken;
+  g_state.branch_was_taken = false;
+  g_state.exception_raised = false;
+  g_state.pc = g_state.npc;
+  g_state.npc += 4;
+
+  ExecuteInstruction<pgxp_mode, false>();
+  UpdateLoadDelay();
+  if (g_state.exception_raised)
+    return false;
+
+  // the nop
+  g_state.pending_ticks++;
+  g_state.pc = g_state.npc;
+  g_state.npc += 4;
+  UpdateLoadDelay();
+  return true;
+}
+
+/// Executes a run of sp-relative lw or sw instructions, checking the address range once instead of for each access.
+/// If any of them could fault or touch something other than RAM, returns false without changing any state, so the
+/// instructions can be executed one at a time and raise exceptions as usual.
+ALWAYS_INLINE_RELEASE static bool ExecuteFusedStackRun(const CodeBlockInstruction* run)
+{
+  const u32 length = run->fused_stack_run_length;
+  const u32 sp = ReadReg(Reg::sp);
+  if ((sp & 3u) != 0)
+    return false;
+
+  s32 min_offset = static_cast<s32>(run[0].instruction.i.imm_sext32());
+  s32 max_offset = min_offset;
+  for (u32 i = 1; i < length; i++)
+  {
+    const s32 offset = static_cast<s32>(run[i].instruction.i.imm_sext32());
+    min_offset = std::min(min_offset, offset);
+    max_offset = std::max(max_offset, offset);
+  }
+
+  // The range can't wrap, and has to be within a single mirror of RAM in one segment.
+  const bool is_store = (run->instruction.op == InstructionOp::sw);
+  const VirtualMemoryAddress start = sp + static_cast<u32>(min_offset);
+  const VirtualMemoryAddress end = sp + static_cast<u32>(max_offset);
+  const u32 segment = start >> 29;
+  if (end < start || (end >> 29) != segment || (segment != 0 && segment != 4 && segment != 5) ||
+      (is_store && segment != 5 && g_state.cop0_regs.sr.Isc))
+  {
+    return false;
+  }
+
+  const PhysicalMemoryAddress phys_start = start & PHYSICAL_MEMORY_ADDRESS_MASK;
+  const PhysicalMemoryAddress phys_end = end & PHYSICAL_MEMORY_ADDRESS_MASK;
+  if (phys_end >= Bus::RAM_MIRROR_END || (phys_start & ~Bus::g_ram_mask) != (phys_end & ~Bus::g_ram_mask))
+    return false;
+
+  if (is_store)
+  {
+    for (u32 i = 0; i < length; i++)
+    {
+      const Instruction inst = run[i].instruction;
+      const u32 offset = (sp + inst.i.imm_sext32()) & Bus::g_ram_mask;
+      const u32 page_index = Bus::GetRAMCodePageIndex(offset);
+      if (Bus::m_ram_code_bits[page_index])
+        InvalidateBlocksWithAddress(page_index, offset);
+
+      const u32 value = ReadReg(inst.i.rt);
+      std::memcpy(&Bus::g_ram[offset], &value, sizeof(value));
+    }
+
+    g_state.pending_ticks += static_cast<TickCount>(length);
+  }
+  else
+  {
+    // Each loaded value is visible after the next instruction, so only the last one is still delayed after the run.
+    for (u32 i = 0; i < length; i++)
+    {
+      const Instruction inst = run[i].instruction;
+      const u32 offset = (sp + inst.i.imm_sext32()) & Bus::g_ram_mask;
+      u32 value;
+      std::memcpy(&value, &Bus::g_ram[offset], sizeof(value));
+
+      if ((i + 1) < length)
+      {
+        g_state.regs.r[static_cast<u8>(inst.i.rt.GetValue())] = value;
+      }
+      else
+      {
+        g_state.load_delay_reg = inst.i.rt;
+        g_state.load_delay_value = value;
+      }
+    }
+
+    g_state.pending_ticks += static_cast<TickCount>(length * (1 + Bus::RAM_READ_TICKS));
+  }
+
+  g_state.pc = g_state.npc + ((length - 1) * 4);
+  g_state.npc += length * 4;
+  return true;
+}
+
 template<PGXPMode pgxp_mode>
 void InterpretCachedBlock(const CodeBlock& block)
 {
@@ -2150,8 +2319,45 @@ void InterpretCachedBlock(const CodeBlock& block)
   DebugAssert(g_state.pc == block.GetPC());
   g_state.npc = block.GetPC() + 4;
 
-  for (const CodeBlockInstruction& cbi : block.instructions)
+  const CodeBlockInstruction* const end = block.instructions.data() + block.instructions.size();
+  for (const CodeBlockInstruction* cbi_ptr = block.instructions.data(); cbi_ptr != end; cbi_ptr++)
   {
+    // PGXP-CPU needs to see each instruction
+    if constexpr (pgxp_mode < PGXPMode::CPU)
+    {
+      if (cbi_ptr->is_fused_constant_load)
+      {
+        ExecuteFusedConstantLoad(cbi_ptr[0], cbi_ptr[1]);
+        cbi_ptr++;
+        continue;
+      }
+      else if (cbi_ptr->is_fused_compare_branch)
+      {
+        ExecuteFusedCompareBranch(cbi_ptr[0], cbi_ptr[1]);
+        cbi_ptr++;
+        continue;
+      }
+      else if (cbi_ptr->is_fused_load_nop)
+      {
+        if (!ExecuteFusedLoadNop<pgxp_mode>(*cbi_ptr))
+          break;
+
+        cbi_ptr++;
+        continue;
+      }
+    }
+
+    // PGXP-Memory needs to see each access
+    if constexpr (pgxp_mode == PGXPMode::Disabled)
+    {
+      if (cbi_ptr->fused_stack_run_length > 0 && ExecuteFusedStackRun(cbi_ptr))
+      {
+        cbi_ptr += cbi_ptr->fused_stack_run_length - 1;
+        continue;
+      }
+    }
+
+    const CodeBlockInstruction& cbi = *cbi_ptr;
     g_state.pending_ticks++;
 
     // now executing the instruction we previously fetched
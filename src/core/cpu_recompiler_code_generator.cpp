@@ -967,6 +967,29 @@ void CodeGenerator::BlockPrologue()
 {
   InitSpeculativeRegs();
 
+  if (CodeCache::CanStartTrace(m_block))
+  {
+    // count executions, and try to replace the block with a trace once it's hot
+    Value count = m_register_cache.AllocateScratch(RegSize_32);
+    EmitLoadGlobal(count.GetHostRegister(), RegSize_32, &m_block->execution_count);
+    EmitAdd(count.GetHostRegister(), count.GetHostRegister(), Value::FromConstantU32(1), false);
+    EmitStoreGlobal(&m_block->execution_count, count);
+
+    LabelType not_hot;
+    EmitConditionalBranch(Condition::NotEqual, false, count.GetHostRegister(),
+                          Value::FromConstantU32(CodeCache::TRACE_EXECUTION_THRESHOLD), &not_hot);
+    m_register_cache.PushState();
+    EmitBranch(GetCurrentFarCodePointer());
+    EmitBindLabel(&not_hot);
+
+    // pc still points to the start of the block, so the dispatcher will pick up the trace
+    SwitchToFarCode();
+    EmitFunctionCall(nullptr, &Thunks::CompileTrace, Value::FromConstantPtr(m_block));
+    EmitEndBlock(true, true);
+    SwitchToNearCode();
+    m_register_cache.PopState();
+  }
+
   EmitStoreCPUStructField(offsetof(State, exception_raised), Value::FromConstantU8(0));
 
 #if 0
@@ -1055,10 +1078,11 @@ void CodeGenerator::InstructionEpilogue(const CodeBlockInstruction& cbi)
 
   if (m_load_delay_dirty)
   {
-    // we have to invalidate the register cache, since the load delayed register might've been cached
+    // the load delayed register might've been cached. the flush reloads cached registers when a delay was pending,
+    // so they can stay in host registers for the rest of the block. constants can't be reloaded, so drop those.
     Log_DebugPrint("Emitting delay slot flush");
+    m_register_cache.InvalidateAllNonDirtyConstantGuestRegisters();
     EmitFlushInterpreterLoadDelay();
-    m_register_cache.InvalidateAllNonDirtyGuestRegisters();
     m_load_delay_dirty = false;
   }
 
@@ -1600,11 +1624,18 @@ bool CodeGenerator::Compile_Store(const CodeBlockInstruction& cbi)
     if (seg == Segment::KUSEG || seg == Segment::KSEG0 || seg == Segment::KSEG1)
     {
       const PhysicalMemoryAddress phys_addr = VirtualAddressToPhysical(*address_spec);
-      const PhysicalMemoryAddress block_start = VirtualAddressToPhysical(m_block->GetPC());
-      const PhysicalMemoryAddress block_end = VirtualAddressToPhysical(
-        m_block->GetPC() + static_cast<u32>(m_block->instructions.size()) * sizeof(Instruction));
+      const PhysicalMemoryAddress block_start = m_block->code_start_address;
+      const PhysicalMemoryAddress block_end = m_block->code_end_address;
       if (phys_addr >= block_start && phys_addr < block_end)
       {
+        // traces aren't contiguous, so they can't be truncated - fall back to the individual blocks instead
+        if (m_block->is_trace)
+        {
+          Log_DevPrintf("Instruction %08X speculatively writes to %08X inside trace %08X-%08X.", cbi.pc, phys_addr,
+                        block_start, block_end);
+          return false;
+        }
+
         Log_WarningPrintf("Instruction %08X speculatively writes to %08X inside block %08X-%08X. Truncating block.",
                           cbi.pc, phys_addr, block_start, block_end);
         TruncateBlockAtCurrentInstruction();
@@ -2201,7 +2232,9 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
 
   auto DoBranch = [this, &cbi](Condition condition, const Value& lhs, const Value& rhs, Reg lr_reg,
                                Value&& branch_target) {
-    const bool can_link_block = cbi.is_direct_branch_instruction && g_settings.cpu_recompiler_block_linking;
+    const bool trace_join = cbi.is_trace_join;
+    const bool can_link_block =
+      cbi.is_direct_branch_instruction && g_settings.cpu_recompiler_block_linking && !trace_join;
 
     // ensure the lr register is flushed, since we want it's correct value after the branch
     // we don't want to invalidate it yet because of "jalr r0, r0", branch_target could be the lr_reg.
@@ -2221,7 +2254,7 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
     LabelType branch_taken, branch_not_taken;
     if (condition != Condition::Always)
     {
-      if (!can_link_block)
+      if (!can_link_block && !trace_join)
       {
         // condition is inverted because we want the case for skipping it
         if (lhs.IsValid() && rhs.IsValid())
@@ -2319,7 +2352,61 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
       m_register_cache.PopState();
     }
 
-    if (can_link_block)
+    if (trace_join)
+    {
+      // the next block of the trace follows the delay slot, so only leave the trace if we went the other way
+      Assert((m_current_instruction + 1) != m_block_end && (m_current_instruction + 2) != m_block_end);
+      InstructionEpilogue(cbi);
+      m_current_instruction++;
+      if (!CompileInstruction(*m_current_instruction))
+        return false;
+
+      const u32 trace_pc = (m_current_instruction + 1)->pc;
+      AddPendingCycles(true);
+
+      auto EmitSideExit = [this](const Value& new_pc) {
+        m_register_cache.PushState();
+        EmitBranch(GetCurrentFarCodePointer());
+        SwitchToFarCode();
+        WriteNewPC(new_pc, false);
+        m_register_cache.FlushAllGuestRegisters(false, false);
+        if (m_register_cache.HasLoadDelay())
+          m_register_cache.WriteLoadDelayToCPU(false);
+        EmitEndBlock(true, true);
+        SwitchToNearCode();
+        m_register_cache.PopState();
+      };
+
+      if (condition != Condition::Always)
+      {
+        DebugAssert(branch_target.IsConstant());
+        const bool expect_taken = (static_cast<u32>(branch_target.constant_value) == trace_pc);
+
+        LabelType stay_on_trace;
+        if (expect_taken)
+          EmitBranchIfBitSet(take_branch.GetHostRegister(), take_branch.size, 0, &stay_on_trace);
+        else
+          EmitBranchIfBitClear(take_branch.GetHostRegister(), take_branch.size, 0, &stay_on_trace);
+        EmitSideExit(expect_taken ? next_pc : branch_target);
+        EmitBindLabel(&stay_on_trace);
+      }
+
+      // pending < downcount
+      {
+        Value pending_ticks = m_register_cache.AllocateScratch(RegSize_32);
+        Value downcount = m_register_cache.AllocateScratch(RegSize_32);
+        EmitLoadCPUStructField(pending_ticks.GetHostRegister(), RegSize_32, offsetof(State, pending_ticks));
+        EmitLoadCPUStructField(downcount.GetHostRegister(), RegSize_32, offsetof(State, downcount));
+
+        LabelType no_events_pending;
+        EmitConditionalBranch(Condition::Less, false, pending_ticks.GetHostRegister(), downcount, &no_events_pending);
+        EmitSideExit(Value::FromConstantU32(trace_pc));
+        EmitBindLabel(&no_events_pending);
+      }
+
+      WriteNewPC(Value::FromConstantU32(trace_pc), true);
+    }
+    else if (can_link_block)
     {
       // if it's an in-block branch, compile the delay slot now
       // TODO: Make this more optimal by moving the condition down if it's a nop
@@ -2348,6 +2435,12 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
         m_register_cache.PushState();
         {
           WriteNewPC(branch_target, false);
+          if (m_block->is_idle_loop)
+          {
+            EmitFunctionCall(&pending_ticks, &CPU::Recompiler::Thunks::SkipIdleLoop,
+                             Value::FromConstantPtr(m_block));
+          }
+
           EmitConditionalBranch(Condition::GreaterEqual, false, pending_ticks.GetHostRegister(), downcount,
                                 &return_to_dispatcher);
 
@@ -2382,6 +2475,8 @@ bool CodeGenerator::Compile_Branch(const CodeBlockInstruction& cbi)
       else
       {
         WriteNewPC(branch_target, true);
+        if (m_block->is_idle_loop)
+          EmitFunctionCall(&pending_ticks, &CPU::Recompiler::Thunks::SkipIdleLoop, Value::FromConstantPtr(m_block));
       }
 
       EmitConditionalBranch(Condition::GreaterEqual, false, pending_ticks.GetHostRegister(), downcount,
@@ -3023,8 +3118,12 @@ bool CodeGenerator::Compile_cop2(const CodeBlockInstruction& cbi)
     StallUntilGTEComplete();
     InstructionPrologue(cbi, 1);
 
-    Value instruction_bits = Value::FromConstantU32(cbi.instruction.bits & GTE::Instruction::REQUIRED_BITS_MASK);
-    EmitFunctionCall(nullptr, func, instruction_bits);
+    if (!EmitGTEInstruction(cbi.instruction.bits & GTE::Instruction::REQUIRED_BITS_MASK))
+    {
+      Value instruction_bits = Value::FromConstantU32(cbi.instruction.bits & GTE::Instruction::REQUIRED_BITS_MASK);
+      EmitFunctionCall(nullptr, func, instruction_bits);
+    }
+
     AddGTETicks(func_ticks);
 
     InstructionEpilogue(cbi);
@@ -3032,12 +3131,21 @@ bool CodeGenerator::Compile_cop2(const CodeBlockInstruction& cbi)
   }
 }
 
+void CodeGenerator::SetSpeculativeInitialState(const Registers* regs, u32 cop0_sr)
+{
+  m_speculative_initial_regs = regs;
+  m_speculative_initial_cop0_sr = cop0_sr;
+}
+
 void CodeGenerator::InitSpeculativeRegs()
 {
+  // When compiling in the background, the CPU state has moved on since the block was looked up.
+  const Registers& regs = m_speculative_initial_regs ? *m_speculative_initial_regs : g_state.regs;
   for (u8 i = 0; i < static_cast<u8>(Reg::count); i++)
-    m_speculative_constants.regs[i] = g_state.regs.r[i];
+    m_speculative_constants.regs[i] = regs.r[i];
 
-  m_speculative_constants.cop0_sr = g_state.cop0_regs.sr.bits;
+  m_speculative_constants.cop0_sr =
+    m_speculative_initial_regs ? m_speculative_initial_cop0_sr : g_state.cop0_regs.sr.bits;
 }
 
 void CodeGenerator::InvalidateSpeculativeValues()
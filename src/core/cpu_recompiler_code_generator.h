@@ -34,6 +34,10 @@ public:
 
   bool CompileBlock(CodeBlock* block, CodeBlock::HostCodePointer* out_host_code, u32* out_host_code_size);
 
+  /// Uses the specified register values for speculative constants, instead of the current CPU state.
+  /// The registers must remain valid until the block is compiled.
+  void SetSpeculativeInitialState(const Registers* regs, u32 cop0_sr);
+
   CodeCache::DispatcherFunction CompileDispatcher();
   CodeCache::SingleBlockDispatcherFunction CompileSingleBlockDispatcher();
 
@@ -78,6 +82,7 @@ public:
   void EmitCancelInterpreterLoadDelayForReg(Reg reg);
   void EmitICacheCheckAndUpdate();
   void EmitStallUntilGTEComplete();
+  bool EmitGTEInstruction(u32 instruction_bits); // false if the GTE function should be called instead
   void EmitLoadCPUStructField(HostReg host_reg, RegSize size, u32 offset);
   void EmitStoreCPUStructField(u32 offset, const Value& value);
   void EmitAddCPUStructField(u32 offset, const Value& value);
@@ -289,6 +294,8 @@ private:
   bool SpeculativeIsCacheIsolated();
 
   SpeculativeConstants m_speculative_constants;
+  const Registers* m_speculative_initial_regs = nullptr;
+  u32 m_speculative_initial_cop0_sr = 0;
 };
 
 } // namespace CPU::Recompiler
@@ -1894,6 +1894,9 @@ void CodeGenerator::EmitFlushInterpreterLoadDelay()
   m_emit->Mov(GetHostReg32(reg), static_cast<u8>(Reg::count));
   m_emit->Strb(GetHostReg32(reg), load_delay_reg);
 
+  // the delayed register might've been cached
+  m_register_cache.ReloadAllNonDirtyGuestRegisters();
+
   m_emit->Bind(&skip_flush);
 }
 
@@ -1997,6 +2000,12 @@ void CodeGenerator::EmitStallUntilGTEComplete()
   m_emit->str(GetHostReg32(RARG1), a64::MemOperand(GetCPUPtrReg(), offsetof(State, pending_ticks)));
 }
 
+bool CodeGenerator::EmitGTEInstruction(u32 instruction_bits)
+{
+  // Not implemented, always call the GTE function.
+  return false;
+}
+
 void CodeGenerator::EmitBranch(const void* address, bool allow_scratch)
 {
   const s64 jump_distance =
@@ -8,6 +8,7 @@
 #include "cpu_core_private.h"
 #include "cpu_recompiler_code_generator.h"
 #include "cpu_recompiler_thunks.h"
+#include "gte.h"
 #include "settings.h"
 #include "timing_event.h"
 Log_SetChannel(Recompiler::CodeGenerator);
@@ -2616,6 +2617,9 @@ void CodeGenerator::EmitFlushInterpreterLoadDelay()
   // load_delay_reg = Reg::count
   m_emit->mov(load_delay_reg, static_cast<u8>(Reg::count));
 
+  // the delayed register might've been cached
+  m_register_cache.ReloadAllNonDirtyGuestRegisters();
+
   m_emit->L(skip_flush);
 }
 
@@ -2701,6 +2705,432 @@ void CodeGenerator::EmitStallUntilGTEComplete()
   m_emit->mov(m_emit->dword[GetCPUPtrReg() + offsetof(State, pending_ticks)], GetHostReg32(RRETURN));
 }
 
+// Registers for inline GTE code. None of these are allocated to guest registers, and RCX is needed for shifts.
+#if defined(ABI_WIN64)
+constexpr HostReg RGTETEMP3 = Xbyak::Operand::R8;
+constexpr HostReg RGTETEMP4 = Xbyak::Operand::R9;
+#elif defined(ABI_SYSV)
+constexpr HostReg RGTETEMP3 = Xbyak::Operand::RDI;
+constexpr HostReg RGTETEMP4 = Xbyak::Operand::RSI;
+#endif
+
+static constexpr u32 GTE_FLAG_ERROR_MASK = UINT32_C(0x7F87E000);
+static constexpr u32 GTE_FLAG_DIVIDE_OVERFLOW = UINT32_C(1) << 17;
+static constexpr u32 GTE_FLAG_SZ1_OTZ_SATURATED = UINT32_C(1) << 18;
+static constexpr u32 GTE_FLAG_SX2_SATURATED = UINT32_C(1) << 14;
+static constexpr u32 GTE_FLAG_SY2_SATURATED = UINT32_C(1) << 13;
+static constexpr u32 GTE_FLAG_IR0_SATURATED = UINT32_C(1) << 12;
+
+static constexpr u32 GTEIRSaturatedFlag(u32 index)
+{
+  return UINT32_C(1) << (25 - index);
+}
+
+static Xbyak::Address GTEReg32(Xbyak::CodeGenerator* e, u32 index)
+{
+  return e->dword[GetCPUPtrReg() + State::GTERegisterOffset(index)];
+}
+
+static Xbyak::Address GTEReg16(Xbyak::CodeGenerator* e, u32 index, u32 half = 0)
+{
+  return e->word[GetCPUPtrReg() + State::GTERegisterOffset(index) + (half * sizeof(u16))];
+}
+
+// 3x3 matrices of s16 packed into five registers.
+static Xbyak::Address GTEMatrixElement(Xbyak::CodeGenerator* e, u32 base_index, u32 row, u32 col)
+{
+  return e->word[GetCPUPtrReg() + State::GTERegisterOffset(base_index) + ((row * 3 + col) * sizeof(s16))];
+}
+
+// Sets the overflow/underflow flag if value doesn't fit in 44 bits for MAC1-3, or 32 bits for MAC0.
+static void EmitGTECheckMAC(Xbyak::CodeGenerator* e, const Xbyak::Reg64& value, const Xbyak::Reg64& temp,
+                            const Xbyak::Reg32& flags, u32 index)
+{
+  const u32 overflow_flag = UINT32_C(1) << ((index == 0) ? 16 : (31 - index));
+  const u32 underflow_flag = UINT32_C(1) << ((index == 0) ? 15 : (28 - index));
+
+  // in range if the bits above are all copies of the sign bit
+  Xbyak::Label done, underflow;
+  e->mov(temp, value);
+  e->sar(temp, (index == 0) ? 31 : 43);
+  e->add(temp, 1);
+  e->cmp(temp, 1);
+  e->jbe(done);
+  e->test(value, value);
+  e->js(underflow);
+  e->or_(flags, overflow_flag);
+  e->jmp(done);
+  e->L(underflow);
+  e->or_(flags, underflow_flag);
+  e->L(done);
+}
+
+static void EmitGTESignExtendMAC(Xbyak::CodeGenerator* e, const Xbyak::Reg64& value)
+{
+  e->shl(value, 64 - 44);
+  e->sar(value, 64 - 44);
+}
+
+// Clamps value to min..max, setting flag if it was outside that range. flag can be zero.
+static void EmitGTEClamp(Xbyak::CodeGenerator* e, const Xbyak::Reg32& value, s32 min, s32 max,
+                         const Xbyak::Reg32& flags, u32 flag)
+{
+  Xbyak::Label done, not_above;
+  e->cmp(value, max);
+  e->jle(not_above);
+  e->mov(value, max);
+  if (flag != 0)
+    e->or_(flags, flag);
+  e->jmp(done);
+  e->L(not_above);
+  e->cmp(value, min);
+  e->jge(done);
+  e->mov(value, min);
+  if (flag != 0)
+    e->or_(flags, flag);
+  e->L(done);
+}
+
+// acc = (T[row] << 12) + M[row] * V, with the overflow checks and truncation after each step that the hardware does.
+// The vector components must be sign-extended to 64 bits. A translation index of zero means no translation.
+static void EmitGTEMulMatVecRow(Xbyak::CodeGenerator* e, const Xbyak::Reg64& acc, const Xbyak::Reg64& temp,
+                                const Xbyak::Reg64& vx, const Xbyak::Reg64& vy, const Xbyak::Reg64& vz,
+                                const Xbyak::Reg32& flags, u32 matrix_index, u32 translation_index,
+                                u32 row)
+{
+  const u32 mac_index = row + 1;
+  if (translation_index != 0)
+  {
+    e->movsxd(acc, GTEReg32(e, translation_index + row));
+    e->shl(acc, 12);
+    e->movsx(temp, GTEMatrixElement(e, matrix_index, row, 0));
+    e->imul(temp, vx);
+    e->add(acc, temp);
+    EmitGTECheckMAC(e, acc, temp, flags, mac_index);
+    EmitGTESignExtendMAC(e, acc);
+  }
+  else
+  {
+    // 16x16 can't overflow
+    e->movsx(acc, GTEMatrixElement(e, matrix_index, row, 0));
+    e->imul(acc, vx);
+  }
+
+  e->movsx(temp, GTEMatrixElement(e, matrix_index, row, 1));
+  e->imul(temp, vy);
+  e->add(acc, temp);
+  EmitGTECheckMAC(e, acc, temp, flags, mac_index);
+  EmitGTESignExtendMAC(e, acc);
+
+  e->movsx(temp, GTEMatrixElement(e, matrix_index, row, 2));
+  e->imul(temp, vz);
+  e->add(acc, temp);
+}
+
+// MAC = acc >> shift, IR = saturate(MAC). Clobbers acc and temp.
+static void EmitGTESetMACAndIR(Xbyak::CodeGenerator* e, const Xbyak::Reg64& acc, const Xbyak::Reg64& temp,
+                               const Xbyak::Reg32& flags, u32 index, u8 shift, bool lm)
+{
+  EmitGTECheckMAC(e, acc, temp, flags, index);
+  if (shift > 0)
+    e->sar(acc, shift);
+
+  const Xbyak::Reg32 acc32 = acc.cvt32();
+  e->mov(GTEReg32(e, 24 + index), acc32);
+  EmitGTEClamp(e, acc32, lm ? 0 : -0x8000, 0x7FFF, flags, GTEIRSaturatedFlag(index));
+  e->mov(GTEReg32(e, 8 + index), acc32);
+}
+
+static void EmitGTEUpdateFlags(Xbyak::CodeGenerator* e, const Xbyak::Reg32& flags)
+{
+  Xbyak::Label no_error;
+  e->test(flags, GTE_FLAG_ERROR_MASK);
+  e->jz(no_error);
+  e->or_(flags, UINT32_C(0x80000000));
+  e->L(no_error);
+  e->mov(GTEReg32(e, 63), flags);
+}
+
+static void EmitGTERTPS(Xbyak::CodeGenerator* e, const Xbyak::Reg32& flags, u32 vertex_index, u8 shift, bool lm,
+                        bool last)
+{
+  const Xbyak::Reg64 rax = e->rax;
+  const Xbyak::Reg64 rcx = e->rcx;
+  const Xbyak::Reg64 rdx = e->rdx;
+  const Xbyak::Reg64 t3 = GetHostReg64(RGTETEMP3);
+  const Xbyak::Reg64 t4 = GetHostReg64(RGTETEMP4);
+
+  // [IR1,IR2,IR3] = [MAC1,MAC2,MAC3] = (TR*1000h + RT*V) SAR (sf*12)
+  const u32 v_index = vertex_index * 2;
+  e->movsx(rcx, GTEReg16(e, v_index, 0));
+  e->movsx(t3, GTEReg16(e, v_index, 1));
+  e->movsx(t4, GTEReg16(e, v_index + 1, 0));
+  for (u32 row = 0; row < 2; row++)
+  {
+    EmitGTEMulMatVecRow(e, rax, rdx, rcx, t3, t4, flags, 32, 37, row);
+    EmitGTESetMACAndIR(e, rax, rdx, flags, row + 1, shift, lm);
+  }
+
+  EmitGTEMulMatVecRow(e, rax, rdx, rcx, t3, t4, flags, 32, 37, 2);
+  EmitGTECheckMAC(e, rax, rdx, flags, 3);
+  e->mov(rdx, rax);
+  if (shift > 0)
+    e->sar(rdx, shift);
+  e->mov(GTEReg32(e, 27), rdx.cvt32());
+
+  // IR3 is saturated from MAC3, but the flag is set from MAC3 SAR 12 regardless of sf.
+  EmitGTEClamp(e, rdx.cvt32(), lm ? 0 : -0x8000, 0x7FFF, flags, 0);
+  e->mov(GTEReg32(e, 11), rdx.cvt32());
+  e->sar(rax, 12);
+  e->mov(rdx.cvt32(), e->eax);
+  EmitGTEClamp(e, rdx.cvt32(), -0x8000, 0x7FFF, flags, GTEIRSaturatedFlag(3));
+
+  // SZ3 = MAC3 SAR ((1-sf)*12), pushed to the FIFO
+  EmitGTEClamp(e, e->eax, 0, 0xFFFF, flags, GTE_FLAG_SZ1_OTZ_SATURATED);
+  for (u32 i = 16; i < 19; i++)
+  {
+    e->mov(e->edx, GTEReg32(e, i + 1));
+    e->mov(GTEReg32(e, i), e->edx);
+  }
+  e->mov(GTEReg32(e, 19), e->eax);
+
+  // UNR division of H by SZ3, result in t4
+  {
+    Xbyak::Label divide, done;
+    e->movzx(t3.cvt32(), GTEReg16(e, 58));
+    e->mov(t4.cvt32(), e->eax);
+    e->mov(e->edx, e->eax);
+    e->add(e->edx, e->edx);
+    e->cmp(e->edx, t3.cvt32());
+    e->ja(divide);
+    e->or_(flags, GTE_FLAG_DIVIDE_OVERFLOW);
+    e->mov(t4.cvt32(), 0x1FFFF);
+    e->jmp(done, Xbyak::CodeGenerator::T_NEAR);
+
+    // normalize so bit 15 of the divisor is set, it can't be zero here
+    e->L(divide);
+    e->bsr(e->edx, t4.cvt32());
+    e->mov(e->ecx, 15);
+    e->sub(e->ecx, e->edx);
+    e->shl(t3.cvt32(), e->cl);
+    e->shl(t4.cvt32(), e->cl);
+
+    // x = 0x101 + table[((divisor & 0x7FFF) + 0x40) >> 7]
+    e->mov(e->edx, t4.cvt32());
+    e->and_(e->edx, 0x7FFF);
+    e->add(e->edx, 0x40);
+    e->shr(e->edx, 7);
+    e->mov(rcx, reinterpret_cast<size_t>(GTE::GetUNRTable()));
+    e->movzx(e->edx, e->byte[rcx + rdx]);
+    e->add(e->edx, 0x101);
+
+    // d = ((divisor * -x) + 0x80) >> 8, recip = ((x * (0x20000 + d)) + 0x80) >> 8
+    e->mov(e->ecx, e->edx);
+    e->neg(e->ecx);
+    e->imul(e->ecx, t4.cvt32());
+    e->add(e->ecx, 0x80);
+    e->sar(e->ecx, 8);
+    e->add(e->ecx, 0x20000);
+    e->imul(e->ecx, e->edx);
+    e->add(e->ecx, 0x80);
+    e->sar(e->ecx, 8);
+
+    // min(0x1FFFF, (lhs * recip + 0x8000) >> 16)
+    e->imul(rcx, t3);
+    e->add(rcx, 0x8000);
+    e->shr(rcx, 16);
+    e->mov(t4.cvt32(), 0x1FFFF);
+    e->cmp(e->ecx, t4.cvt32());
+    e->cmovb(t4.cvt32(), e->ecx);
+    e->L(done);
+  }
+
+  // MAC0 = result * IR1 * scale + OFX, SX2 = MAC0 SAR 16
+  e->movsx(rax, GTEReg16(e, 9));
+  e->imul(rax, t4);
+  {
+    Xbyak::Label no_scale;
+    e->mov(rcx, reinterpret_cast<size_t>(GTE::GetProjectionXScale()));
+    e->movsxd(rdx, e->dword[rcx]);
+    e->movsxd(rcx, e->dword[rcx + sizeof(s32)]);
+    e->imul(rax, rdx);
+    e->cmp(e->ecx, 1);
+    e->je(no_scale);
+    e->cqo();
+    e->idiv(rcx);
+    e->L(no_scale);
+  }
+  e->movsxd(rdx, GTEReg32(e, 56));
+  e->add(rax, rdx);
+  EmitGTECheckMAC(e, rax, rdx, flags, 0);
+  e->sar(rax, 16);
+  EmitGTEClamp(e, e->eax, -1024, 1023, flags, GTE_FLAG_SX2_SATURATED);
+  e->movzx(t3.cvt32(), e->ax);
+
+  // MAC0 = result * IR2 + OFY, SY2 = MAC0 SAR 16
+  e->movsx(rax, GTEReg16(e, 10));
+  e->imul(rax, t4);
+  e->movsxd(rdx, GTEReg32(e, 57));
+  e->add(rax, rdx);
+  EmitGTECheckMAC(e, rax, rdx, flags, 0);
+  e->sar(rax, 16);
+  EmitGTEClamp(e, e->eax, -1024, 1023, flags, GTE_FLAG_SY2_SATURATED);
+  e->shl(e->eax, 16);
+  e->or_(e->eax, t3.cvt32());
+  for (u32 i = 12; i < 14; i++)
+  {
+    e->mov(e->edx, GTEReg32(e, i + 1));
+    e->mov(GTEReg32(e, i), e->edx);
+  }
+  e->mov(GTEReg32(e, 14), e->eax);
+
+  if (last)
+  {
+    // MAC0 = result * DQA + DQB, IR0 = MAC0 SAR 12
+    e->movsx(rax, GTEReg16(e, 59));
+    e->imul(rax, t4);
+    e->movsxd(rdx, GTEReg32(e, 60));
+    e->add(rax, rdx);
+    EmitGTECheckMAC(e, rax, rdx, flags, 0);
+    e->mov(GTEReg32(e, 24), e->eax);
+    e->sar(rax, 12);
+    EmitGTEClamp(e, e->eax, 0, 0x1000, flags, GTE_FLAG_IR0_SATURATED);
+    e->mov(GTEReg32(e, 8), e->eax);
+  }
+}
+
+bool CodeGenerator::EmitGTEInstruction(u32 instruction_bits)
+{
+  const GTE::Instruction inst{instruction_bits};
+  const u8 shift = inst.GetShift();
+  const bool lm = inst.lm;
+
+  switch (inst.command)
+  {
+    case 0x01: // RTPS
+    case 0x30: // RTPT
+    {
+      // PGXP needs the unrounded values.
+      if (g_settings.gpu_pgxp_enable)
+        return false;
+
+      Value flags = m_register_cache.AllocateScratch(RegSize_32);
+      m_emit->xor_(GetHostReg32(flags), GetHostReg32(flags));
+      if (inst.command == 0x01)
+      {
+        EmitGTERTPS(m_emit, GetHostReg32(flags), 0, shift, lm, true);
+      }
+      else
+      {
+        for (u32 i = 0; i < 3; i++)
+          EmitGTERTPS(m_emit, GetHostReg32(flags), i, shift, lm, i == 2);
+      }
+
+      EmitGTEUpdateFlags(m_emit, GetHostReg32(flags));
+      return true;
+    }
+
+    case 0x06: // NCLIP
+    {
+      if (g_settings.gpu_pgxp_enable && g_settings.gpu_pgxp_culling)
+        return false;
+
+      // MAC0 = SX0*SY1 + SX1*SY2 + SX2*SY0 - SX0*SY2 - SX1*SY0 - SX2*SY1
+      static constexpr std::array<std::array<u32, 2>, 6> terms = {
+        {{12, 13}, {13, 14}, {14, 12}, {12, 14}, {13, 12}, {14, 13}}};
+
+      Value flags = m_register_cache.AllocateScratch(RegSize_32);
+      m_emit->xor_(GetHostReg32(flags), GetHostReg32(flags));
+      m_emit->xor_(m_emit->eax, m_emit->eax);
+      for (u32 i = 0; i < terms.size(); i++)
+      {
+        m_emit->movsx(m_emit->rdx, GTEReg16(m_emit, terms[i][0], 0));
+        m_emit->movsx(m_emit->rcx, GTEReg16(m_emit, terms[i][1], 1));
+        m_emit->imul(m_emit->rdx, m_emit->rcx);
+        if (i < 3)
+          m_emit->add(m_emit->rax, m_emit->rdx);
+        else
+          m_emit->sub(m_emit->rax, m_emit->rdx);
+      }
+
+      EmitGTECheckMAC(m_emit, m_emit->rax, m_emit->rdx, GetHostReg32(flags), 0);
+      m_emit->mov(GTEReg32(m_emit, 24), m_emit->eax);
+      EmitGTEUpdateFlags(m_emit, GetHostReg32(flags));
+      return true;
+    }
+
+    case 0x2D: // AVSZ3
+    case 0x2E: // AVSZ4
+    {
+      // MAC0 = ZSF * (SZ0 + SZ1 + SZ2 + SZ3), OTZ = MAC0 SAR 12
+      const bool avsz4 = (inst.command == 0x2E);
+      Value flags = m_register_cache.AllocateScratch(RegSize_32);
+      m_emit->xor_(GetHostReg32(flags), GetHostReg32(flags));
+      m_emit->movzx(m_emit->eax, GTEReg16(m_emit, 19));
+      for (u32 i = avsz4 ? 16 : 17; i < 19; i++)
+      {
+        m_emit->movzx(m_emit->edx, GTEReg16(m_emit, i));
+        m_emit->add(m_emit->eax, m_emit->edx);
+      }
+      m_emit->movsx(m_emit->rdx, GTEReg16(m_emit, avsz4 ? 62 : 61));
+      m_emit->imul(m_emit->rax, m_emit->rdx);
+
+      EmitGTECheckMAC(m_emit, m_emit->rax, m_emit->rdx, GetHostReg32(flags), 0);
+      m_emit->mov(GTEReg32(m_emit, 24), m_emit->eax);
+      m_emit->sar(m_emit->rax, 12);
+      EmitGTEClamp(m_emit, m_emit->eax, 0, 0xFFFF, GetHostReg32(flags), GTE_FLAG_SZ1_OTZ_SATURATED);
+      m_emit->mov(GTEReg32(m_emit, 7), m_emit->eax);
+      EmitGTEUpdateFlags(m_emit, GetHostReg32(flags));
+      return true;
+    }
+
+    case 0x12: // MVMVA
+    {
+      // The garbage matrix and the broken FC translation are rare enough to leave to the GTE.
+      if (inst.mvmva_multiply_matrix == 3 || inst.mvmva_translation_vector == 2)
+        return false;
+
+      static constexpr std::array<u32, 3> matrix_indices = {{32, 40, 48}};     // RT, LLM, LCM
+      static constexpr std::array<u32, 4> translation_indices = {{37, 45, 53, 0}}; // TR, BK, FC, none
+      const u32 matrix_index = matrix_indices[inst.mvmva_multiply_matrix];
+      const u32 translation_index = translation_indices[inst.mvmva_translation_vector];
+
+      // The vector has to be read before anything is written, since it can be IR.
+      const Xbyak::Reg64 vx = m_emit->rcx;
+      const Xbyak::Reg64 vy = GetHostReg64(RGTETEMP3);
+      const Xbyak::Reg64 vz = GetHostReg64(RGTETEMP4);
+      if (inst.mvmva_multiply_vector == 3)
+      {
+        m_emit->movsx(vx, GTEReg16(m_emit, 9));
+        m_emit->movsx(vy, GTEReg16(m_emit, 10));
+        m_emit->movsx(vz, GTEReg16(m_emit, 11));
+      }
+      else
+      {
+        const u32 v_index = inst.mvmva_multiply_vector * 2;
+        m_emit->movsx(vx, GTEReg16(m_emit, v_index, 0));
+        m_emit->movsx(vy, GTEReg16(m_emit, v_index, 1));
+        m_emit->movsx(vz, GTEReg16(m_emit, v_index + 1, 0));
+      }
+
+      Value flags = m_register_cache.AllocateScratch(RegSize_32);
+      m_emit->xor_(GetHostReg32(flags), GetHostReg32(flags));
+      for (u32 row = 0; row < 3; row++)
+      {
+        EmitGTEMulMatVecRow(m_emit, m_emit->rax, m_emit->rdx, vx, vy, vz, GetHostReg32(flags), matrix_index,
+                            translation_index, row);
+        EmitGTESetMACAndIR(m_emit, m_emit->rax, m_emit->rdx, GetHostReg32(flags), row + 1, shift, lm);
+      }
+
+      EmitGTEUpdateFlags(m_emit, GetHostReg32(flags));
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
 void CodeGenerator::EmitBranch(const void* address, bool allow_scratch)
 {
   const s64 jump_distance =
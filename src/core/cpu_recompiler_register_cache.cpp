@@ -827,16 +827,29 @@ void RegisterCache::InvalidateGuestRegister(Reg guest_reg)
   cache_value.Clear();
 }
 
-void RegisterCache::InvalidateAllNonDirtyGuestRegisters()
+void RegisterCache::InvalidateAllNonDirtyConstantGuestRegisters()
 {
   for (u8 reg = 0; reg < static_cast<u8>(Reg::count); reg++)
   {
     Value& cache_value = m_state.guest_reg_state[reg];
-    if (cache_value.IsValid() && !cache_value.IsDirty())
+    if (cache_value.IsConstant() && !cache_value.IsDirty())
       InvalidateGuestRegister(static_cast<Reg>(reg));
   }
 }
 
+void RegisterCache::ReloadAllNonDirtyGuestRegisters()
+{
+  for (u8 reg = 0; reg < static_cast<u8>(Reg::count); reg++)
+  {
+    const Value& cache_value = m_state.guest_reg_state[reg];
+    if (cache_value.IsInHostRegister() && !cache_value.IsDirty())
+    {
+      Log_DebugPrintf("Reloading guest register %s", GetRegName(static_cast<Reg>(reg)));
+      m_code_generator.EmitLoadGuestRegister(cache_value.GetHostRegister(), static_cast<Reg>(reg));
+    }
+  }
+}
+
 void RegisterCache::FlushAllGuestRegisters(bool invalidate, bool clear_dirty)
 {
   for (u8 reg = 0; reg < static_cast<u8>(Reg::count); reg++)
@@ -340,7 +340,13 @@ public:
   void FlushGuestRegister(Reg guest_reg, bool invalidate, bool clear_dirty);
   void InvalidateGuestRegister(Reg guest_reg);
 
-  void InvalidateAllNonDirtyGuestRegisters();
+  /// Invalidates guest registers which hold a constant but aren't dirty. These can't be reloaded from the CPU state.
+  void InvalidateAllNonDirtyConstantGuestRegisters();
+
+  /// Reloads guest registers which are in host registers but aren't dirty from the CPU state. Only emits code, so it
+  /// can be used in a conditional path without changing the cache state.
+  void ReloadAllNonDirtyGuestRegisters();
+
   void FlushAllGuestRegisters(bool invalidate, bool clear_dirty);
   void FlushCallerSavedGuestRegisters(bool invalidate, bool clear_dirty);
   bool EvictOneGuestRegister();
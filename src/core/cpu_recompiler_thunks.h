@@ -37,6 +37,12 @@ void UncheckedWriteMemoryHalfWord(u32 address, u32 value);
 void UncheckedWriteMemoryWord(u32 address, u32 value);
 
 void ResolveBranch(CodeBlock* block, void* host_pc, void* host_resolve_pc, u32 host_pc_size);
+
+// Called when an idle loop branches back to itself. Returns the new pending ticks.
+TickCount SkipIdleLoop(CodeBlock* block);
+
+// Called when a block becomes hot enough to start a trace. The block exits to the dispatcher afterwards.
+void CompileTrace(CodeBlock* block);
 void LogPC(u32 pc);
 
 } // namespace Recompiler::Thunks
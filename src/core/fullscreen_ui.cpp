@@ -3763,6 +3763,9 @@ void FullscreenUI::DrawDisplaySettingsPage()
       DrawToggleSetting(bsi, FSUI_CSTR("Threaded Rendering"),
                         FSUI_CSTR("Uses a second thread for drawing graphics. Speed boost, and safe to use."), "GPU",
                         "UseThread", true);
+      DrawIntRangeSetting(bsi, FSUI_CSTR("Rasterizer Threads"),
+                          FSUI_CSTR("Splits the screen into bands which are drawn in parallel. 0 or 1 disables."),
+                          "GPU", "SoftwareRendererThreads", 0, 0, 32, "%d threads");
     }
     break;
 
@@ -4698,6 +4701,9 @@ void FullscreenUI::DrawAdvancedSettingsPage()
     bsi, FSUI_CSTR("Enable Recompiler Block Linking"),
     FSUI_CSTR("Performance enhancement - jumps directly between blocks instead of returning to the dispatcher."), "CPU",
     "RecompilerBlockLinking", true);
+  DrawToggleSetting(bsi, FSUI_CSTR("Enable Recompiler Block Cache"),
+                    FSUI_CSTR("Saves analysed blocks per-game, and compiles them ahead of execution on later boots."),
+                    "CPU", "RecompilerBlockCache", false);
   DrawEnumSetting(bsi, FSUI_CSTR("Recompiler Fast Memory Access"),
                   FSUI_CSTR("Avoids calls to C++ code, significantly speeding up the recompiler."), "CPU",
                   "FastmemMode", Settings::DEFAULT_CPU_FASTMEM_MODE, &Settings::ParseCPUFastmemMode,
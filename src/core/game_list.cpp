@@ -21,11 +21,15 @@
 #include "common/path.h"
 #include "common/progress_callback.h"
 #include "common/string_util.h"
+#include "common/thirdparty/thread_pool.h"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cctype>
+#include <condition_variable>
 #include <ctime>
+#include <mutex>
 #include <string_view>
 #include <type_traits>
 #include <unordered_map>
@@ -70,8 +74,8 @@ static void ScanDirectory(const char* path, bool recursive, bool only_cache,
                           const std::vector<std::string>& excluded_paths, const PlayedTimeMap& played_time_map,
                           ProgressCallback* progress);
 static bool AddFileFromCache(const std::string& path, std::time_t timestamp, const PlayedTimeMap& played_time_map);
-static bool ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
-                     const PlayedTimeMap& played_time_map);
+static bool ScanFile(std::string path, std::time_t timestamp, Entry* entry);
+static void AddScannedEntry(Entry entry, const PlayedTimeMap& played_time_map);
 
 static std::string GetCacheFilename();
 static void LoadCache();
@@ -480,14 +484,15 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
   progress->SetProgressRange(static_cast<u32>(files.size()));
   progress->SetProgressValue(0);
 
+  // Cache hits are cheap, so handle those here, and only hand the files which actually need to be opened to the pool.
   u32 files_scanned = 0;
+  std::vector<FILESYSTEM_FIND_DATA*> files_to_scan;
   for (FILESYSTEM_FIND_DATA& ffd : files)
   {
-    files_scanned++;
-
     if (progress->IsCancelled() || !GameList::IsScannableFilename(ffd.FileName) ||
         IsPathExcluded(excluded_paths, ffd.FileName))
     {
+      files_scanned++;
       continue;
     }
 
@@ -495,12 +500,78 @@ void GameList::ScanDirectory(const char* path, bool recursive, bool only_cache,
     if (GetEntryForPath(ffd.FileName.c_str()) ||
         AddFileFromCache(ffd.FileName, ffd.ModificationTime, played_time_map) || only_cache)
     {
+      files_scanned++;
       continue;
     }
 
-    progress->SetFormattedStatusText("Scanning '%s'...", FileSystem::GetDisplayNameFromPath(ffd.FileName).c_str());
-    ScanFile(std::move(ffd.FileName), ffd.ModificationTime, lock, played_time_map);
-    progress->SetProgressValue(files_scanned);
+    files_to_scan.push_back(&ffd);
+  }
+
+  progress->SetProgressValue(files_scanned);
+
+  if (!files_to_scan.empty() && !progress->IsCancelled())
+  {
+    // Workers only open and hash the images. The cache file, entry list and progress callback are only touched from
+    // this thread, so everything is written by a single writer.
+    struct ScanResult
+    {
+      Entry entry;
+      bool valid;
+    };
+
+    std::mutex results_mutex;
+    std::condition_variable results_cv;
+    std::vector<ScanResult> results;
+    std::vector<ScanResult> completed_results;
+    std::atomic_bool cancelled{false};
+
+    // The database isn't safe to load concurrently.
+    GameDatabase::EnsureLoaded();
+
+    const int num_workers = static_cast<int>(
+      std::min<size_t>(std::max(cb::ThreadPool::GetNumLogicalCores(), 1u), files_to_scan.size()));
+    Log_DevPrintf("Scanning %zu files with %d workers", files_to_scan.size(), num_workers);
+
+    cb::ThreadPool pool(num_workers);
+    for (FILESYSTEM_FIND_DATA* ffd : files_to_scan)
+    {
+      pool.Schedule([ffd, &results_mutex, &results_cv, &results, &cancelled]() {
+        ScanResult result;
+        result.valid = !cancelled.load(std::memory_order_relaxed) &&
+                       ScanFile(std::move(ffd->FileName), ffd->ModificationTime, &result.entry);
+
+        std::unique_lock lock(results_mutex);
+        results.push_back(std::move(result));
+        results_cv.notify_one();
+      });
+    }
+
+    size_t files_remaining = files_to_scan.size();
+    while (files_remaining > 0)
+    {
+      {
+        std::unique_lock lock(results_mutex);
+        results_cv.wait(lock, [&results]() { return !results.empty(); });
+        completed_results.swap(results);
+      }
+
+      for (ScanResult& result : completed_results)
+      {
+        files_scanned++;
+        files_remaining--;
+        if (!result.valid)
+          continue;
+
+        progress->SetFormattedStatusText("Scanning '%s'...",
+                                         FileSystem::GetDisplayNameFromPath(result.entry.path).c_str());
+        AddScannedEntry(std::move(result.entry), played_time_map);
+      }
+      completed_results.clear();
+
+      progress->SetProgressValue(files_scanned);
+      if (progress->IsCancelled())
+        cancelled.store(true, std::memory_order_relaxed);
+    }
   }
 
   progress->SetProgressValue(files_scanned);
@@ -524,21 +595,20 @@ bool GameList::AddFileFromCache(const std::string& path, std::time_t timestamp,
   return true;
 }
 
-bool GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_lock<std::recursive_mutex>& lock,
-                        const PlayedTimeMap& played_time_map)
+bool GameList::ScanFile(std::string path, std::time_t timestamp, Entry* entry)
 {
-  // don't block UI while scanning
-  lock.unlock();
-
   Log_DevPrintf("Scanning '%s'...", path.c_str());
 
-  Entry entry;
-  if (!PopulateEntryFromPath(path, &entry))
+  if (!PopulateEntryFromPath(path, entry))
     return false;
 
-  entry.path = std::move(path);
-  entry.last_modified_time = timestamp;
+  entry->path = std::move(path);
+  entry->last_modified_time = timestamp;
+  return true;
+}
 
+void GameList::AddScannedEntry(Entry entry, const PlayedTimeMap& played_time_map)
+{
   if (s_cache_write_stream || OpenCacheForWriting())
   {
     if (!WriteEntryToCache(&entry))
@@ -552,9 +622,8 @@ bool GameList::ScanFile(std::string path, std::time_t timestamp, std::unique_loc
     entry.total_played_time = iter->second.total_played_time;
   }
 
-  lock.lock();
+  std::unique_lock lock(s_mutex);
   s_entries.push_back(std::move(entry));
-  return true;
 }
 
 std::unique_lock<std::recursive_mutex> GameList::GetLock()
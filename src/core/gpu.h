@@ -82,6 +82,7 @@ public:
 
   virtual GPURenderer GetRendererType() const = 0;
   virtual const Threading::Thread* GetSWThread() const = 0;
+  virtual u64 GetSWRasterThreadsCPUTime() const = 0;
 
   virtual bool Initialize();
   virtual void Reset(bool clear_vram);
@@ -4,11 +4,37 @@
 #include "gpu_backend.h"
 #include "common/align.h"
 #include "common/log.h"
+#include "common/platform.h"
 #include "common/timer.h"
 #include "settings.h"
 #include "util/state_wrapper.h"
+#include <algorithm>
+#include <thread>
 Log_SetChannel(GPUBackend);
 
+#if defined(CPU_X64) || defined(CPU_X86)
+#include <immintrin.h>
+#endif
+
+/// Busy-waits for a short while, then starts giving up the timeslice in case the other thread is sharing our core.
+static ALWAYS_INLINE void SpinWait(u32& spin_count)
+{
+  static constexpr u32 PAUSE_SPIN_COUNT = 64;
+  if (spin_count < PAUSE_SPIN_COUNT)
+  {
+    spin_count++;
+#if defined(CPU_X64) || defined(CPU_X86)
+    _mm_pause();
+#elif defined(CPU_AARCH64) && !defined(_MSC_VER)
+    __asm__ __volatile__("yield");
+#endif
+  }
+  else
+  {
+    std::this_thread::yield();
+  }
+}
+
 std::unique_ptr<GPUBackend> g_gpu_backend;
 
 GPUBackend::GPUBackend() = default;
@@ -102,40 +128,52 @@ void* GPUBackend::AllocateCommand(GPUBackendCommandType command, u32 size)
   // Ensure size is a multiple of 4 so we don't end up with an unaligned command.
   size = Common::AlignUpPow2(size, 4);
 
+  // The read pointer is cached, so we only touch the GPU thread's cache line when we're running low on space.
+  u32 spin_count = 0;
   for (;;)
   {
-    u32 read_ptr = m_command_fifo_read_ptr.load();
-    u32 write_ptr = m_command_fifo_write_ptr.load();
+    const u32 write_ptr = m_command_fifo_pending_write_ptr;
+    const u32 read_ptr = m_command_fifo_cached_read_ptr;
     if (read_ptr > write_ptr)
     {
-      u32 available_size = read_ptr - write_ptr;
-      while (available_size < (size + sizeof(GPUBackendCommandType)))
-      {
-        WakeGPUThread();
-        read_ptr = m_command_fifo_read_ptr.load();
-        available_size = (read_ptr > write_ptr) ? (read_ptr - write_ptr) : (COMMAND_QUEUE_SIZE - write_ptr);
-      }
+      // Never let the write pointer catch up to the read pointer, otherwise the queue would appear empty.
+      if ((read_ptr - write_ptr) > size)
+        break;
     }
     else
     {
+      // Always leave room for the wraparound command at the end of the buffer.
       const u32 available_size = COMMAND_QUEUE_SIZE - write_ptr;
-      if ((size + sizeof(GPUBackendCommand)) > available_size)
+      if ((size + sizeof(GPUBackendCommand)) <= available_size)
+        break;
+
+      // Can't wrap until the GPU thread has moved off the start of the buffer.
+      if (read_ptr != 0)
       {
         // allocate a dummy command to wrap the buffer around
         GPUBackendCommand* dummy_cmd = reinterpret_cast<GPUBackendCommand*>(&m_command_fifo_data[write_ptr]);
         dummy_cmd->type = GPUBackendCommandType::Wraparound;
         dummy_cmd->size = available_size;
         dummy_cmd->params.bits = 0;
-        m_command_fifo_write_ptr.store(0);
+        m_command_fifo_pending_write_ptr = 0;
+        m_command_fifo_unpublished_size += available_size;
         continue;
       }
     }
 
-    GPUBackendCommand* cmd = reinterpret_cast<GPUBackendCommand*>(&m_command_fifo_data[write_ptr]);
-    cmd->type = command;
-    cmd->size = size;
-    return cmd;
+    // Queue is full, make sure the GPU thread can see everything we've written, and wait for it to catch up.
+    if (m_command_fifo_unpublished_size > 0)
+      PublishCommands();
+    else
+      SpinWait(spin_count);
+
+    m_command_fifo_cached_read_ptr = m_command_fifo_read_ptr.load(std::memory_order_acquire);
   }
+
+  GPUBackendCommand* cmd = reinterpret_cast<GPUBackendCommand*>(&m_command_fifo_data[m_command_fifo_pending_write_ptr]);
+  cmd->type = command;
+  cmd->size = size;
+  return cmd;
 }
 
 u32 GPUBackend::GetPendingCommandSize() const
@@ -155,25 +193,47 @@ void GPUBackend::PushCommand(GPUBackendCommand* cmd)
   }
   else
   {
-    const u32 new_write_ptr = m_command_fifo_write_ptr.fetch_add(cmd->size) + cmd->size;
-    DebugAssert(new_write_ptr <= COMMAND_QUEUE_SIZE);
-    UNREFERENCED_VARIABLE(new_write_ptr);
-    if (GetPendingCommandSize() >= THRESHOLD_TO_WAKE_GPU)
-      WakeGPUThread();
+    m_command_fifo_pending_write_ptr += cmd->size;
+    m_command_fifo_unpublished_size += cmd->size;
+    m_commands_since_sync = true;
+    DebugAssert(m_command_fifo_pending_write_ptr <= COMMAND_QUEUE_SIZE);
+    if (m_command_fifo_unpublished_size >= THRESHOLD_TO_WAKE_GPU)
+      PublishCommands();
   }
 }
 
+void GPUBackend::FlushCommands()
+{
+  if (m_use_gpu_thread && m_command_fifo_unpublished_size > 0)
+    PublishCommands();
+}
+
+void GPUBackend::PublishCommands()
+{
+  // Needs to be sequentially consistent with the load of m_gpu_thread_sleeping, see RunGPULoop().
+  m_command_fifo_write_ptr.store(m_command_fifo_pending_write_ptr);
+  m_command_fifo_unpublished_size = 0;
+  WakeGPUThread();
+}
+
 void GPUBackend::WakeGPUThread()
 {
-  std::unique_lock<std::mutex> lock(m_sync_mutex);
+  // Only take the lock when the GPU thread is actually parked, otherwise it'll pick up the new commands itself.
   if (!m_gpu_thread_sleeping.load())
     return;
 
+  std::unique_lock<std::mutex> lock(m_sync_mutex);
   m_wake_gpu_thread_cv.notify_one();
 }
 
 void GPUBackend::StartGPUThread()
 {
+  m_command_fifo_read_ptr.store(0);
+  m_command_fifo_write_ptr.store(0);
+  m_command_fifo_pending_write_ptr = 0;
+  m_command_fifo_cached_read_ptr = 0;
+  m_command_fifo_unpublished_size = 0;
+  m_commands_since_sync = false;
   m_gpu_loop_done.store(false);
   m_use_gpu_thread = true;
   m_gpu_thread.Start([this]() { RunGPULoop(); });
@@ -186,7 +246,10 @@ void GPUBackend::StopGPUThread()
     return;
 
   m_gpu_loop_done.store(true);
-  WakeGPUThread();
+  {
+    std::unique_lock<std::mutex> lock(m_sync_mutex);
+    m_wake_gpu_thread_cv.notify_one();
+  }
   m_gpu_thread.Join();
   m_use_gpu_thread = false;
   Log_InfoPrint("GPU thread stopped.");
@@ -195,32 +258,83 @@ void GPUBackend::StopGPUThread()
 void GPUBackend::Sync(bool allow_sleep)
 {
   if (!m_use_gpu_thread)
+  {
+    FlushRender();
+    return;
+  }
+
+  // Nothing has been queued since the last sync completed, so the GPU thread has nothing left to do.
+  if (!m_commands_since_sync)
     return;
 
   GPUBackendSyncCommand* cmd =
     static_cast<GPUBackendSyncCommand*>(AllocateCommand(GPUBackendCommandType::Sync, sizeof(GPUBackendSyncCommand)));
   cmd->allow_sleep = allow_sleep;
+  m_sync_done.store(false, std::memory_order_relaxed);
   PushCommand(cmd);
-  WakeGPUThread();
+  PublishCommands();
 
-  m_sync_semaphore.Wait();
+  WaitForSync();
+  m_commands_since_sync = false;
+}
+
+void GPUBackend::WaitForSync()
+{
+  // Small batches are usually done before the kernel could put us to sleep, so spin for a bit first.
+  static constexpr double SPIN_TIME_NS = 50 * 1000;
+  if (m_sync_done.load(std::memory_order_acquire))
+    return;
+
+  const Common::Timer::Value start_time = Common::Timer::GetCurrentValue();
+  u32 spin_count = 0;
+  while (Common::Timer::ConvertValueToNanoseconds(Common::Timer::GetCurrentValue() - start_time) < SPIN_TIME_NS)
+  {
+    SpinWait(spin_count);
+    if (m_sync_done.load(std::memory_order_acquire))
+      return;
+  }
+
+  std::unique_lock<std::mutex> lock(m_sync_mutex);
+  m_cpu_thread_sleeping.store(true);
+  m_sync_cpu_thread_cv.wait(lock, [this]() { return m_sync_done.load(); });
+  m_cpu_thread_sleeping.store(false);
 }
 
 void GPUBackend::RunGPULoop()
 {
-  static constexpr double SPIN_TIME_NS = 1 * 1000000;
+  // Spin time is adjusted based on whether commands turned up while spinning.
+  static constexpr double MIN_SPIN_TIME_NS = 16 * 1000;
+  static constexpr double MAX_SPIN_TIME_NS = 1 * 1000000;
+  double spin_time_ns = MAX_SPIN_TIME_NS;
   Common::Timer::Value last_command_time = 0;
+  u32 spin_count = 0;
+  bool spinning = false;
 
   for (;;)
   {
-    u32 write_ptr = m_command_fifo_write_ptr.load();
-    u32 read_ptr = m_command_fifo_read_ptr.load();
+    u32 write_ptr = m_command_fifo_write_ptr.load(std::memory_order_acquire);
+    u32 read_ptr = m_command_fifo_read_ptr.load(std::memory_order_relaxed);
     if (read_ptr == write_ptr)
     {
-      const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
-      if (Common::Timer::ConvertValueToNanoseconds(current_time - last_command_time) < SPIN_TIME_NS)
-        continue;
+      if (last_command_time != 0)
+      {
+        const Common::Timer::Value current_time = Common::Timer::GetCurrentValue();
+        if (Common::Timer::ConvertValueToNanoseconds(current_time - last_command_time) < spin_time_ns)
+        {
+          spinning = true;
+          SpinWait(spin_count);
+          continue;
+        }
 
+        // Nothing turned up, don't burn as much time next time.
+        spin_time_ns = std::max(spin_time_ns * 0.5, MIN_SPIN_TIME_NS);
+      }
+
+      spinning = false;
+      spin_count = 0;
+
+      // Sleeping flag store must be sequentially consistent with the write pointer load in the predicate, pairs with
+      // PublishCommands(), so that we can't miss a wakeup.
       std::unique_lock<std::mutex> lock(m_sync_mutex);
       m_gpu_thread_sleeping.store(true);
       m_wake_gpu_thread_cv.wait(lock, [this]() { return m_gpu_loop_done.load() || GetPendingCommandSize() > 0; });
@@ -232,6 +346,14 @@ void GPUBackend::RunGPULoop()
         continue;
     }
 
+    if (spinning)
+    {
+      // Commands arrived while we were spinning, so the spin saved a wakeup.
+      spin_time_ns = std::min(spin_time_ns * 2.0, MAX_SPIN_TIME_NS);
+      spinning = false;
+      spin_count = 0;
+    }
+
     if (write_ptr < read_ptr)
       write_ptr = COMMAND_QUEUE_SIZE;
 
@@ -246,7 +368,8 @@ void GPUBackend::RunGPULoop()
         case GPUBackendCommandType::Wraparound:
         {
           DebugAssert(read_ptr == COMMAND_QUEUE_SIZE);
-          write_ptr = m_command_fifo_write_ptr.load();
+          m_command_fifo_read_ptr.store(0, std::memory_order_release);
+          write_ptr = m_command_fifo_write_ptr.load(std::memory_order_acquire);
           read_ptr = 0;
         }
         break;
@@ -254,8 +377,16 @@ void GPUBackend::RunGPULoop()
         case GPUBackendCommandType::Sync:
         {
           DebugAssert(read_ptr == write_ptr);
-          m_sync_semaphore.Post();
+          FlushRender();
           allow_sleep = static_cast<const GPUBackendSyncCommand*>(cmd)->allow_sleep;
+
+          // Pairs with the sleeping flag store in WaitForSync().
+          m_sync_done.store(true);
+          if (m_cpu_thread_sleeping.load())
+          {
+            std::unique_lock<std::mutex> lock(m_sync_mutex);
+            m_sync_cpu_thread_cv.notify_one();
+          }
         }
         break;
 
@@ -266,7 +397,7 @@ void GPUBackend::RunGPULoop()
     }
 
     last_command_time = allow_sleep ? 0 : Common::Timer::GetCurrentValue();
-    m_command_fifo_read_ptr.store(read_ptr);
+    m_command_fifo_read_ptr.store(read_ptr, std::memory_order_release);
   }
 }
 
@@ -41,13 +41,18 @@ public:
   void PushCommand(GPUBackendCommand* cmd);
   void Sync(bool allow_sleep);
 
+  /// Makes commands which are still below the wake threshold visible to the GPU thread.
+  void FlushCommands();
+
   /// Processes all pending GPU commands.
   void RunGPULoop();
 
 protected:
   void* AllocateCommand(GPUBackendCommandType command, u32 size);
   u32 GetPendingCommandSize() const;
+  void PublishCommands();
   void WakeGPUThread();
+  void WaitForSync();
   void StartGPUThread();
   void StopGPUThread();
 
@@ -68,16 +73,12 @@ protected:
 
   Common::Rectangle<u32> m_drawing_area{};
 
-  Threading::KernelSemaphore m_sync_semaphore;
-  std::atomic_bool m_gpu_thread_sleeping{false};
-  std::atomic_bool m_gpu_loop_done{false};
   Threading::Thread m_gpu_thread;
   bool m_use_gpu_thread = false;
 
   std::mutex m_sync_mutex;
   std::condition_variable m_sync_cpu_thread_cv;
   std::condition_variable m_wake_gpu_thread_cv;
-  bool m_sync_done = false;
 
   enum : u32
   {
@@ -86,8 +87,23 @@ protected:
   };
 
   FixedHeapArray<u8, COMMAND_QUEUE_SIZE> m_command_fifo_data;
+
+  // Written by the GPU thread.
   alignas(64) std::atomic<u32> m_command_fifo_read_ptr{0};
+  std::atomic_bool m_gpu_thread_sleeping{false};
+  std::atomic_bool m_sync_done{false};
+
+  // Written by the CPU thread. The write pointer is only published once enough commands have been queued, or on
+  // flush/sync.
   alignas(64) std::atomic<u32> m_command_fifo_write_ptr{0};
+  std::atomic_bool m_cpu_thread_sleeping{false};
+  std::atomic_bool m_gpu_loop_done{false};
+
+  // Only accessed by the CPU thread.
+  alignas(64) u32 m_command_fifo_pending_write_ptr = 0;
+  u32 m_command_fifo_cached_read_ptr = 0;
+  u32 m_command_fifo_unpublished_size = 0;
+  bool m_commands_since_sync = false;
 };
 
 #ifdef _MSC_VER
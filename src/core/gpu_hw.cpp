@@ -57,6 +57,11 @@ const Threading::Thread* GPU_HW::GetSWThread() const
   return m_sw_renderer ? m_sw_renderer->GetThread() : nullptr;
 }
 
+u64 GPU_HW::GetSWRasterThreadsCPUTime() const
+{
+  return m_sw_renderer ? m_sw_renderer->GetRasterThreadsCPUTime() : 0;
+}
+
 bool GPU_HW::Initialize()
 {
   if (!GPU::Initialize())
@@ -37,6 +37,7 @@ public:
   virtual ~GPU_HW();
 
   const Threading::Thread* GetSWThread() const override;
+  u64 GetSWRasterThreadsCPUTime() const override;
 
   virtual bool Initialize() override;
   virtual void Reset(bool clear_vram) override;
@@ -52,6 +52,11 @@ const Threading::Thread* GPU_SW::GetSWThread() const
   return m_backend.GetThread();
 }
 
+u64 GPU_SW::GetSWRasterThreadsCPUTime() const
+{
+  return m_backend.GetRasterThreadsCPUTime();
+}
+
 bool GPU_SW::Initialize()
 {
   if (!GPU::Initialize() || !m_backend.Initialize(false))
@@ -847,6 +852,12 @@ void GPU_SW::DispatchRenderCommand()
   }
 }
 
+void GPU_SW::FlushRender()
+{
+  // Don't leave a partial batch sitting in the queue until the next sync, e.g. at the end of the frame.
+  m_backend.FlushCommands();
+}
+
 void GPU_SW::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
 {
   m_backend.Sync(false);
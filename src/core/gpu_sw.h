@@ -27,6 +27,7 @@ public:
 
   GPURenderer GetRendererType() const override;
   const Threading::Thread* GetSWThread() const override;
+  u64 GetSWRasterThreadsCPUTime() const override;
 
   bool Initialize() override;
   bool DoState(StateWrapper& sw, GPUTexture** host_texture, bool update_display) override;
@@ -54,6 +55,7 @@ protected:
   void UpdateDisplay() override;
 
   void DispatchRenderCommand() override;
+  void FlushRender() override;
 
   void FillBackendCommandParameters(GPUBackendCommand* cmd) const;
   void FillDrawCommand(GPUBackendDrawCommand* cmd, GPURenderCommand rc) const;
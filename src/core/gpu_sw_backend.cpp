@@ -4,23 +4,57 @@
 #include "gpu_sw_backend.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/string.h"
 #include "gpu_sw_backend.h"
+#include "settings.h"
 #include "util/host_display.h"
 #include "system.h"
 #include <algorithm>
+#include <cstring>
+#include <limits>
 Log_SetChannel(GPU_SW_Backend);
 
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#elif defined(CPU_AARCH64)
+#ifdef _MSC_VER
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 GPU_SW_Backend::GPU_SW_Backend() : GPUBackend()
 {
   m_vram.fill(0);
   m_vram_ptr = m_vram.data();
 }
 
-GPU_SW_Backend::~GPU_SW_Backend() = default;
+GPU_SW_Backend::~GPU_SW_Backend()
+{
+  StopRasterThreads();
+}
 
 bool GPU_SW_Backend::Initialize(bool force_thread)
 {
-  return GPUBackend::Initialize(force_thread);
+  if (!GPUBackend::Initialize(force_thread))
+    return false;
+
+  StartRasterThreads(g_settings.gpu_sw_threads);
+  return true;
+}
+
+void GPU_SW_Backend::UpdateSettings()
+{
+  GPUBackend::UpdateSettings();
+
+  // GPU thread is idle after the sync in the base class, so we can safely restart the raster threads here.
+  const u32 new_thread_count = (g_settings.gpu_sw_threads > 1) ? g_settings.gpu_sw_threads : 0;
+  if (static_cast<u32>(m_raster_threads.size()) != new_thread_count)
+  {
+    StopRasterThreads();
+    StartRasterThreads(new_thread_count);
+  }
 }
 
 void GPU_SW_Backend::Reset(bool clear_vram)
@@ -31,7 +65,77 @@ void GPU_SW_Backend::Reset(bool clear_vram)
     m_vram.fill(0);
 }
 
+void GPU_SW_Backend::Shutdown()
+{
+  GPUBackend::Shutdown();
+  StopRasterThreads();
+}
+
+template<typename Vertex>
+static Common::Rectangle<u32> GetVertexBounds(const Vertex* vertices, u32 num_vertices,
+                                              const Common::Rectangle<u32>& drawing_area)
+{
+  // Coordinates outside the 11-bit range can wrap around when truncated, so assume the whole drawing area is touched.
+  s32 min_x = std::numeric_limits<s32>::max(), max_x = std::numeric_limits<s32>::min();
+  s32 min_y = std::numeric_limits<s32>::max(), max_y = std::numeric_limits<s32>::min();
+  for (u32 i = 0; i < num_vertices; i++)
+  {
+    const Vertex& v = vertices[i];
+    if (v.x < -1024 || v.x > 1023 || v.y < -1024 || v.y > 1023)
+      return Common::Rectangle<u32>(drawing_area.left, drawing_area.top, drawing_area.right + 1, drawing_area.bottom + 1);
+
+    min_x = std::min(min_x, v.x);
+    max_x = std::max(max_x, v.x);
+    min_y = std::min(min_y, v.y);
+    max_y = std::max(max_y, v.y);
+  }
+
+  return Common::Rectangle<u32>(
+    static_cast<u32>(std::clamp<s32>(min_x, drawing_area.left, drawing_area.right + 1)),
+    static_cast<u32>(std::clamp<s32>(min_y, drawing_area.top, drawing_area.bottom + 1)),
+    static_cast<u32>(std::clamp<s32>(max_x + 1, drawing_area.left, drawing_area.right + 1)),
+    static_cast<u32>(std::clamp<s32>(max_y + 1, drawing_area.top, drawing_area.bottom + 1)));
+}
+
 void GPU_SW_Backend::DrawPolygon(const GPUBackendDrawPolygonCommand* cmd)
+{
+  if (!IsUsingRasterThreads())
+  {
+    RasterizePolygon(cmd, m_drawing_area);
+    return;
+  }
+
+  QueueRasterCommand(cmd, GetVertexBounds(cmd->vertices, cmd->num_vertices, m_drawing_area));
+}
+
+void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+{
+  if (!IsUsingRasterThreads())
+  {
+    RasterizeRectangle(cmd, m_drawing_area);
+    return;
+  }
+
+  const Common::Rectangle<u32> bounds(
+    static_cast<u32>(std::clamp<s32>(cmd->x, m_drawing_area.left, m_drawing_area.right + 1)),
+    static_cast<u32>(std::clamp<s32>(cmd->y, m_drawing_area.top, m_drawing_area.bottom + 1)),
+    static_cast<u32>(std::clamp<s32>(cmd->x + cmd->width, m_drawing_area.left, m_drawing_area.right + 1)),
+    static_cast<u32>(std::clamp<s32>(cmd->y + cmd->height, m_drawing_area.top, m_drawing_area.bottom + 1)));
+  QueueRasterCommand(cmd, bounds);
+}
+
+void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd)
+{
+  if (!IsUsingRasterThreads())
+  {
+    RasterizeLine(cmd, m_drawing_area);
+    return;
+  }
+
+  QueueRasterCommand(cmd, GetVertexBounds(cmd->vertices, cmd->num_vertices, m_drawing_area));
+}
+
+void GPU_SW_Backend::RasterizePolygon(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area)
 {
   const GPURenderCommand rc{cmd->rc.bits};
   const bool dithering_enable = rc.IsDitheringEnabled() && cmd->draw_mode.dither_enable;
@@ -39,28 +143,28 @@ void GPU_SW_Backend::DrawPolygon(const GPUBackendDrawPolygonCommand* cmd)
   const DrawTriangleFunction DrawFunction = GetDrawTriangleFunction(
     rc.shading_enable, rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable, dithering_enable);
 
-  (this->*DrawFunction)(cmd, &cmd->vertices[0], &cmd->vertices[1], &cmd->vertices[2]);
+  (this->*DrawFunction)(cmd, area, &cmd->vertices[0], &cmd->vertices[1], &cmd->vertices[2]);
   if (rc.quad_polygon)
-    (this->*DrawFunction)(cmd, &cmd->vertices[2], &cmd->vertices[1], &cmd->vertices[3]);
+    (this->*DrawFunction)(cmd, area, &cmd->vertices[2], &cmd->vertices[1], &cmd->vertices[3]);
 }
 
-void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+void GPU_SW_Backend::RasterizeRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& area)
 {
   const GPURenderCommand rc{cmd->rc.bits};
 
   const DrawRectangleFunction DrawFunction =
     GetDrawRectangleFunction(rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable);
 
-  (this->*DrawFunction)(cmd);
+  (this->*DrawFunction)(cmd, area);
 }
 
-void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd)
+void GPU_SW_Backend::RasterizeLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& area)
 {
   const DrawLineFunction DrawFunction =
     GetDrawLineFunction(cmd->rc.shading_enable, cmd->rc.transparency_enable, cmd->IsDitheringEnabled());
 
   for (u16 i = 1; i < cmd->num_vertices; i++)
-    (this->*DrawFunction)(cmd, &cmd->vertices[i - 1], &cmd->vertices[i]);
+    (this->*DrawFunction)(cmd, area, &cmd->vertices[i - 1], &cmd->vertices[i]);
 }
 
 constexpr GPU_SW_Backend::DitherLUT GPU_SW_Backend::ComputeDitherLUT()
@@ -82,6 +186,42 @@ constexpr GPU_SW_Backend::DitherLUT GPU_SW_Backend::ComputeDitherLUT()
 
 static constexpr GPU_SW_Backend::DitherLUT s_dither_lut = GPU_SW_Backend::ComputeDitherLUT();
 
+ALWAYS_INLINE_RELEASE u16 GPU_SW_Backend::GetTexturePixel(const GPUBackendDrawCommand* cmd, u8 texcoord_x,
+                                                          u8 texcoord_y) const
+{
+  // Apply texture window
+  texcoord_x = (texcoord_x & cmd->window.and_x) | cmd->window.or_x;
+  texcoord_y = (texcoord_y & cmd->window.and_y) | cmd->window.or_y;
+
+  switch (cmd->draw_mode.texture_mode)
+  {
+    case GPUTextureMode::Palette4Bit:
+    {
+      const u16 palette_value =
+        GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 4)) % VRAM_WIDTH,
+                 (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+      const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
+
+      return GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
+    }
+
+    case GPUTextureMode::Palette8Bit:
+    {
+      const u16 palette_value =
+        GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 2)) % VRAM_WIDTH,
+                 (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+      const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
+      return GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
+    }
+
+    default:
+    {
+      return GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x)) % VRAM_WIDTH,
+                      (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
+    }
+  }
+}
+
 template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
 void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r,
                                                       u8 color_g, u8 color_b, u8 texcoord_x, u8 texcoord_y)
@@ -89,43 +229,8 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawComman
   VRAMPixel color;
   if constexpr (texture_enable)
   {
-    // Apply texture window
-    texcoord_x = (texcoord_x & cmd->window.and_x) | cmd->window.or_x;
-    texcoord_y = (texcoord_y & cmd->window.and_y) | cmd->window.or_y;
-
     VRAMPixel texture_color;
-    switch (cmd->draw_mode.texture_mode)
-    {
-      case GPUTextureMode::Palette4Bit:
-      {
-        const u16 palette_value =
-          GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 4)) % VRAM_WIDTH,
-                   (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-        const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
-
-        texture_color.bits =
-          GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
-      }
-      break;
-
-      case GPUTextureMode::Palette8Bit:
-      {
-        const u16 palette_value =
-          GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x / 2)) % VRAM_WIDTH,
-                   (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-        const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
-        texture_color.bits =
-          GetPixel((cmd->palette.GetXBase() + ZeroExtend32(palette_index)) % VRAM_WIDTH, cmd->palette.GetYBase());
-      }
-      break;
-
-      default:
-      {
-        texture_color.bits = GetPixel((cmd->draw_mode.GetTexturePageBaseX() + ZeroExtend32(texcoord_x)) % VRAM_WIDTH,
-                                      (cmd->draw_mode.GetTexturePageBaseY() + ZeroExtend32(texcoord_y)) % VRAM_HEIGHT);
-      }
-      break;
-    }
+    texture_color.bits = GetTexturePixel(cmd, texcoord_x, texcoord_y);
 
     if (texture_color.bits == 0)
       return;
@@ -222,18 +327,316 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixel(const GPUBackendDrawComman
   SetPixel(static_cast<u32>(x), static_cast<u32>(y), color.bits | cmd->params.GetMaskOR());
 }
 
+#ifdef USE_VECTOR_SPANS
+
+// Thin wrappers so the span kernel can be shared between SSE2 and NEON. All lanes are 16-bit.
+#if defined(CPU_X64)
+using VectorU16 = __m128i;
+static ALWAYS_INLINE VectorU16 VectorLoad(const u16* ptr)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+}
+static ALWAYS_INLINE void VectorStore(u16* ptr, VectorU16 v)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(ptr), v);
+}
+static ALWAYS_INLINE VectorU16 VectorSet(u16 v)
+{
+  return _mm_set1_epi16(static_cast<s16>(v));
+}
+static ALWAYS_INLINE VectorU16 VectorAdd(VectorU16 a, VectorU16 b)
+{
+  return _mm_add_epi16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorSubSaturateU(VectorU16 a, VectorU16 b)
+{
+  return _mm_subs_epu16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorMul(VectorU16 a, VectorU16 b)
+{
+  return _mm_mullo_epi16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorAnd(VectorU16 a, VectorU16 b)
+{
+  return _mm_and_si128(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorAndNot(VectorU16 a, VectorU16 b)
+{
+  // a & ~b
+  return _mm_andnot_si128(b, a);
+}
+static ALWAYS_INLINE VectorU16 VectorOr(VectorU16 a, VectorU16 b)
+{
+  return _mm_or_si128(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorMinS(VectorU16 a, VectorU16 b)
+{
+  return _mm_min_epi16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorMaxS(VectorU16 a, VectorU16 b)
+{
+  return _mm_max_epi16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorCompareEq(VectorU16 a, VectorU16 b)
+{
+  return _mm_cmpeq_epi16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorSelect(VectorU16 mask, VectorU16 a, VectorU16 b)
+{
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+template<int n>
+static ALWAYS_INLINE VectorU16 VectorShiftLeft(VectorU16 v)
+{
+  return _mm_slli_epi16(v, n);
+}
+template<int n>
+static ALWAYS_INLINE VectorU16 VectorShiftRight(VectorU16 v)
+{
+  return _mm_srli_epi16(v, n);
+}
+template<int n>
+static ALWAYS_INLINE VectorU16 VectorShiftRightArithmetic(VectorU16 v)
+{
+  return _mm_srai_epi16(v, n);
+}
+#elif defined(CPU_AARCH64)
+using VectorU16 = uint16x8_t;
+static ALWAYS_INLINE VectorU16 VectorLoad(const u16* ptr)
+{
+  return vld1q_u16(ptr);
+}
+static ALWAYS_INLINE void VectorStore(u16* ptr, VectorU16 v)
+{
+  vst1q_u16(ptr, v);
+}
+static ALWAYS_INLINE VectorU16 VectorSet(u16 v)
+{
+  return vdupq_n_u16(v);
+}
+static ALWAYS_INLINE VectorU16 VectorAdd(VectorU16 a, VectorU16 b)
+{
+  return vaddq_u16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorSubSaturateU(VectorU16 a, VectorU16 b)
+{
+  return vqsubq_u16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorMul(VectorU16 a, VectorU16 b)
+{
+  return vmulq_u16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorAnd(VectorU16 a, VectorU16 b)
+{
+  return vandq_u16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorAndNot(VectorU16 a, VectorU16 b)
+{
+  // a & ~b
+  return vbicq_u16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorOr(VectorU16 a, VectorU16 b)
+{
+  return vorrq_u16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorMinS(VectorU16 a, VectorU16 b)
+{
+  return vreinterpretq_u16_s16(vminq_s16(vreinterpretq_s16_u16(a), vreinterpretq_s16_u16(b)));
+}
+static ALWAYS_INLINE VectorU16 VectorMaxS(VectorU16 a, VectorU16 b)
+{
+  return vreinterpretq_u16_s16(vmaxq_s16(vreinterpretq_s16_u16(a), vreinterpretq_s16_u16(b)));
+}
+static ALWAYS_INLINE VectorU16 VectorCompareEq(VectorU16 a, VectorU16 b)
+{
+  return vceqq_u16(a, b);
+}
+static ALWAYS_INLINE VectorU16 VectorSelect(VectorU16 mask, VectorU16 a, VectorU16 b)
+{
+  return vbslq_u16(mask, a, b);
+}
+template<int n>
+static ALWAYS_INLINE VectorU16 VectorShiftLeft(VectorU16 v)
+{
+  return vshlq_n_u16(v, n);
+}
+template<int n>
+static ALWAYS_INLINE VectorU16 VectorShiftRight(VectorU16 v)
+{
+  return vshrq_n_u16(v, n);
+}
+template<int n>
+static ALWAYS_INLINE VectorU16 VectorShiftRightArithmetic(VectorU16 v)
+{
+  return vreinterpretq_u16_s16(vshrq_n_s16(vreinterpretq_s16_u16(v), n));
+}
+#endif
+
+/// Dither offsets for each lane, indexed by the low bits of Y and the starting X.
+static constexpr std::array<std::array<std::array<s16, GPU_SW_Backend::SPAN_VECTOR_WIDTH>, DITHER_MATRIX_SIZE>,
+                            DITHER_MATRIX_SIZE>
+ComputeDitherVectors()
+{
+  std::array<std::array<std::array<s16, GPU_SW_Backend::SPAN_VECTOR_WIDTH>, DITHER_MATRIX_SIZE>, DITHER_MATRIX_SIZE>
+    vectors = {};
+  for (u32 y = 0; y < DITHER_MATRIX_SIZE; y++)
+  {
+    for (u32 x = 0; x < DITHER_MATRIX_SIZE; x++)
+    {
+      for (u32 lane = 0; lane < GPU_SW_Backend::SPAN_VECTOR_WIDTH; lane++)
+        vectors[y][x][lane] = static_cast<s16>(DITHER_MATRIX[y][(x + lane) % DITHER_MATRIX_SIZE]);
+    }
+  }
+  return vectors;
+}
+
+alignas(16) static constexpr auto s_dither_vectors = ComputeDitherVectors();
+
+/// Vector equivalent of the dither LUT, i.e. clamp((value + offset) >> 3, 0, 31).
+static ALWAYS_INLINE VectorU16 DitherChannel(VectorU16 value, VectorU16 offset)
+{
+  return VectorMinS(VectorMaxS(VectorShiftRightArithmetic<3>(VectorAdd(value, offset)), VectorSet(0)), VectorSet(31));
+}
+
+template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
+void ALWAYS_INLINE_RELEASE GPU_SW_Backend::ShadePixels(const GPUBackendDrawCommand* cmd, u32 x, u32 y,
+                                                       const u16* color_r, const u16* color_g, const u16* color_b,
+                                                       const u8* texcoord_x, const u8* texcoord_y)
+{
+  const VectorU16 channel_mask = VectorSet(0x1F);
+  const VectorU16 zero = VectorSet(0);
+
+  u16* const dst_ptr = GetPixelPtr(x, y);
+  const VectorU16 bg_color = VectorLoad(dst_ptr);
+  VectorU16 write_mask = VectorSet(0xFFFF);
+  VectorU16 color;
+
+  const VectorU16 dither =
+    dithering_enable ? VectorLoad(reinterpret_cast<const u16*>(s_dither_vectors[y & 3u][x & 3u].data())) : zero;
+
+  if constexpr (texture_enable)
+  {
+    // Texture lookups are dependent reads, so they're done per-lane.
+    alignas(16) u16 texture_colors[SPAN_VECTOR_WIDTH];
+    for (u32 i = 0; i < SPAN_VECTOR_WIDTH; i++)
+      texture_colors[i] = GetTexturePixel(cmd, texcoord_x[i], texcoord_y[i]);
+
+    const VectorU16 texture_color = VectorLoad(texture_colors);
+    write_mask = VectorAndNot(write_mask, VectorCompareEq(texture_color, zero));
+
+    if constexpr (raw_texture_enable)
+    {
+      color = texture_color;
+    }
+    else
+    {
+      const VectorU16 r = DitherChannel(
+        VectorShiftRight<4>(VectorMul(VectorAnd(texture_color, channel_mask), VectorLoad(color_r))), dither);
+      const VectorU16 g = DitherChannel(
+        VectorShiftRight<4>(VectorMul(VectorAnd(VectorShiftRight<5>(texture_color), channel_mask), VectorLoad(color_g))),
+        dither);
+      const VectorU16 b = DitherChannel(
+        VectorShiftRight<4>(VectorMul(VectorAnd(VectorShiftRight<10>(texture_color), channel_mask), VectorLoad(color_b))),
+        dither);
+      color = VectorOr(VectorOr(r, VectorShiftLeft<5>(g)),
+                       VectorOr(VectorShiftLeft<10>(b), VectorAnd(texture_color, VectorSet(0x8000))));
+    }
+  }
+  else
+  {
+    const VectorU16 r = DitherChannel(VectorLoad(color_r), dither);
+    const VectorU16 g = DitherChannel(VectorLoad(color_g), dither);
+    const VectorU16 b = DitherChannel(VectorLoad(color_b), dither);
+
+    // Non-textured transparent polygons don't set bit 15, but are treated as transparent.
+    color = VectorOr(VectorOr(r, VectorShiftLeft<5>(g)),
+                     VectorOr(VectorShiftLeft<10>(b), VectorSet(transparency_enable ? 0x8000 : 0)));
+  }
+
+  if constexpr (transparency_enable)
+  {
+    // Per-channel equivalent of the blending in ShadePixel(). Bit 15 is always set on the result when texturing.
+    const VectorU16 bg_r = VectorAnd(bg_color, channel_mask);
+    const VectorU16 bg_g = VectorAnd(VectorShiftRight<5>(bg_color), channel_mask);
+    const VectorU16 bg_b = VectorAnd(VectorShiftRight<10>(bg_color), channel_mask);
+    VectorU16 fg_r = VectorAnd(color, channel_mask);
+    VectorU16 fg_g = VectorAnd(VectorShiftRight<5>(color), channel_mask);
+    VectorU16 fg_b = VectorAnd(VectorShiftRight<10>(color), channel_mask);
+    switch (cmd->draw_mode.transparency_mode)
+    {
+      case GPUTransparencyMode::HalfBackgroundPlusHalfForeground:
+      {
+        fg_r = VectorShiftRight<1>(VectorAdd(bg_r, fg_r));
+        fg_g = VectorShiftRight<1>(VectorAdd(bg_g, fg_g));
+        fg_b = VectorShiftRight<1>(VectorAdd(bg_b, fg_b));
+      }
+      break;
+
+      case GPUTransparencyMode::BackgroundPlusForeground:
+      {
+        fg_r = VectorMinS(VectorAdd(bg_r, fg_r), channel_mask);
+        fg_g = VectorMinS(VectorAdd(bg_g, fg_g), channel_mask);
+        fg_b = VectorMinS(VectorAdd(bg_b, fg_b), channel_mask);
+      }
+      break;
+
+      case GPUTransparencyMode::BackgroundMinusForeground:
+      {
+        fg_r = VectorSubSaturateU(bg_r, fg_r);
+        fg_g = VectorSubSaturateU(bg_g, fg_g);
+        fg_b = VectorSubSaturateU(bg_b, fg_b);
+      }
+      break;
+
+      case GPUTransparencyMode::BackgroundPlusQuarterForeground:
+      {
+        fg_r = VectorMinS(VectorAdd(bg_r, VectorShiftRight<2>(fg_r)), channel_mask);
+        fg_g = VectorMinS(VectorAdd(bg_g, VectorShiftRight<2>(fg_g)), channel_mask);
+        fg_b = VectorMinS(VectorAdd(bg_b, VectorShiftRight<2>(fg_b)), channel_mask);
+      }
+      break;
+    }
+
+    const VectorU16 blended =
+      VectorOr(VectorOr(fg_r, VectorShiftLeft<5>(fg_g)),
+               VectorOr(VectorShiftLeft<10>(fg_b), VectorSet(texture_enable ? 0x8000 : 0)));
+    if constexpr (texture_enable)
+      color = VectorSelect(VectorCompareEq(VectorAnd(color, VectorSet(0x8000)), zero), color, blended);
+    else
+      color = blended;
+  }
+
+  const u16 mask_and = cmd->params.GetMaskAND();
+  if (mask_and != 0)
+    write_mask = VectorAnd(write_mask, VectorCompareEq(VectorAnd(bg_color, VectorSet(mask_and)), zero));
+
+  VectorStore(dst_ptr, VectorSelect(write_mask, VectorOr(color, VectorSet(cmd->params.GetMaskOR())), bg_color));
+}
+
+#endif // USE_VECTOR_SPANS
+
 template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
+void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& area)
 {
   const s32 origin_x = cmd->x;
   const s32 origin_y = cmd->y;
   const auto [r, g, b] = UnpackColorRGB24(cmd->color);
   const auto [origin_texcoord_x, origin_texcoord_y] = UnpackTexcoord(cmd->texcoord);
 
+#ifdef USE_VECTOR_SPANS
+  alignas(16) u16 colors_r[SPAN_VECTOR_WIDTH];
+  alignas(16) u16 colors_g[SPAN_VECTOR_WIDTH];
+  alignas(16) u16 colors_b[SPAN_VECTOR_WIDTH];
+  std::fill_n(colors_r, SPAN_VECTOR_WIDTH, r);
+  std::fill_n(colors_g, SPAN_VECTOR_WIDTH, g);
+  std::fill_n(colors_b, SPAN_VECTOR_WIDTH, b);
+  const Common::Rectangle<u32> texture_rect = GetTextureSourceRectangle(cmd);
+#endif
+
   for (u32 offset_y = 0; offset_y < cmd->height; offset_y++)
   {
     const s32 y = origin_y + static_cast<s32>(offset_y);
-    if (y < static_cast<s32>(m_drawing_area.top) || y > static_cast<s32>(m_drawing_area.bottom) ||
+    if (y < static_cast<s32>(area.top) || y > static_cast<s32>(area.bottom) ||
         (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y)) & 1u)))
     {
       continue;
@@ -241,13 +644,34 @@ void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd)
 
     const u8 texcoord_y = Truncate8(ZeroExtend32(origin_texcoord_y) + offset_y);
 
-    for (u32 offset_x = 0; offset_x < cmd->width; offset_x++)
+    const s32 x_start = std::max(origin_x, static_cast<s32>(area.left));
+    const s32 x_end = std::min(origin_x + static_cast<s32>(cmd->width), static_cast<s32>(area.right) + 1);
+    s32 x = x_start;
+
+#ifdef USE_VECTOR_SPANS
+    // See DrawSpan() for why sampling from the row being drawn has to use the scalar path.
+    const bool use_vector =
+      (x_end > x_start) && (!texture_enable || !texture_rect.Intersects(Common::Rectangle<u32>(
+                                                 static_cast<u32>(x_start), static_cast<u32>(y),
+                                                 static_cast<u32>(x_end), static_cast<u32>(y) + 1)));
+    for (; use_vector && (x + static_cast<s32>(SPAN_VECTOR_WIDTH)) <= x_end; x += SPAN_VECTOR_WIDTH)
     {
-      const s32 x = origin_x + static_cast<s32>(offset_x);
-      if (x < static_cast<s32>(m_drawing_area.left) || x > static_cast<s32>(m_drawing_area.right))
-        continue;
+      alignas(16) u8 texcoord_x[SPAN_VECTOR_WIDTH];
+      alignas(16) u8 texcoord_y_vec[SPAN_VECTOR_WIDTH];
+      for (u32 i = 0; i < SPAN_VECTOR_WIDTH; i++)
+      {
+        texcoord_x[i] = Truncate8(ZeroExtend32(origin_texcoord_x) + static_cast<u32>(x - origin_x) + i);
+        texcoord_y_vec[i] = texcoord_y;
+      }
+
+      ShadePixels<texture_enable, raw_texture_enable, transparency_enable, false>(
+        cmd, static_cast<u32>(x), static_cast<u32>(y), colors_r, colors_g, colors_b, texcoord_x, texcoord_y_vec);
+    }
+#endif
 
-      const u8 texcoord_x = Truncate8(ZeroExtend32(origin_texcoord_x) + offset_x);
+    for (; x < x_end; x++)
+    {
+      const u8 texcoord_x = Truncate8(ZeroExtend32(origin_texcoord_x) + static_cast<u32>(x - origin_x));
 
       ShadePixel<texture_enable, raw_texture_enable, transparency_enable, false>(
         cmd, static_cast<u32>(x), static_cast<u32>(y), r, g, b, texcoord_x, texcoord_y);
@@ -363,8 +787,8 @@ void ALWAYS_INLINE_RELEASE GPU_SW_Backend::AddIDeltas_DY(i_group& ig, const i_de
 
 template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
          bool dithering_enable>
-void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s32 x_start, s32 x_bound, i_group ig,
-                              const i_deltas& idl)
+void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area, s32 y,
+                              s32 x_start, s32 x_bound, i_group ig, const i_deltas& idl)
 {
   if (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (Truncate8(static_cast<u32>(y)) & 1u))
     return;
@@ -373,16 +797,16 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
   s32 w = x_bound - x_start;
   s32 x = TruncateGPUVertexPosition(x_start);
 
-  if (x < static_cast<s32>(m_drawing_area.left))
+  if (x < static_cast<s32>(area.left))
   {
-    s32 delta = static_cast<s32>(m_drawing_area.left) - x;
+    s32 delta = static_cast<s32>(area.left) - x;
     x_ig_adjust += delta;
     x += delta;
     w -= delta;
   }
 
-  if ((x + w) > (static_cast<s32>(m_drawing_area.right) + 1))
-    w = static_cast<s32>(m_drawing_area.right) + 1 - x;
+  if ((x + w) > (static_cast<s32>(area.right) + 1))
+    w = static_cast<s32>(area.right) + 1 - x;
 
   if (w <= 0)
     return;
@@ -390,6 +814,43 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
   AddIDeltas_DX<shading_enable, texture_enable>(ig, idl, x_ig_adjust);
   AddIDeltas_DY<shading_enable, texture_enable>(ig, idl, y);
 
+#ifdef USE_VECTOR_SPANS
+  // Texels are fetched for the whole vector before any pixels are written, which gives different results to the
+  // scalar path if the span samples from itself.
+  if (w >= static_cast<s32>(SPAN_VECTOR_WIDTH) &&
+      (!texture_enable || !GetTextureSourceRectangle(cmd).Intersects(Common::Rectangle<u32>::FromExtents(
+                            static_cast<u32>(x), static_cast<u32>(y), static_cast<u32>(w), 1))))
+  {
+    alignas(16) u16 colors_r[SPAN_VECTOR_WIDTH];
+    alignas(16) u16 colors_g[SPAN_VECTOR_WIDTH];
+    alignas(16) u16 colors_b[SPAN_VECTOR_WIDTH];
+    alignas(16) u8 texcoords_x[SPAN_VECTOR_WIDTH];
+    alignas(16) u8 texcoords_y[SPAN_VECTOR_WIDTH];
+
+    do
+    {
+      for (u32 i = 0; i < SPAN_VECTOR_WIDTH; i++)
+      {
+        colors_r[i] = Truncate8(ig.r >> (COORD_FBS + COORD_POST_PADDING));
+        colors_g[i] = Truncate8(ig.g >> (COORD_FBS + COORD_POST_PADDING));
+        colors_b[i] = Truncate8(ig.b >> (COORD_FBS + COORD_POST_PADDING));
+        texcoords_x[i] = Truncate8(ig.u >> (COORD_FBS + COORD_POST_PADDING));
+        texcoords_y[i] = Truncate8(ig.v >> (COORD_FBS + COORD_POST_PADDING));
+        AddIDeltas_DX<shading_enable, texture_enable>(ig, idl);
+      }
+
+      ShadePixels<texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
+        cmd, static_cast<u32>(x), static_cast<u32>(y), colors_r, colors_g, colors_b, texcoords_x, texcoords_y);
+
+      x += SPAN_VECTOR_WIDTH;
+      w -= SPAN_VECTOR_WIDTH;
+    } while (w >= static_cast<s32>(SPAN_VECTOR_WIDTH));
+
+    if (w == 0)
+      return;
+  }
+#endif
+
   do
   {
     const u32 r = ig.r >> (COORD_FBS + COORD_POST_PADDING);
@@ -409,7 +870,7 @@ void GPU_SW_Backend::DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s3
 
 template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
          bool dithering_enable>
-void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
+void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area,
                                   const GPUBackendDrawPolygonCommand::Vertex* v0,
                                   const GPUBackendDrawPolygonCommand::Vertex* v1,
                                   const GPUBackendDrawPolygonCommand::Vertex* v2)
@@ -567,14 +1028,14 @@ void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
 
         s32 y = TruncateGPUVertexPosition(yi);
 
-        if (y < static_cast<s32>(m_drawing_area.top))
+        if (y < static_cast<s32>(area.top))
           break;
 
-        if (y > static_cast<s32>(m_drawing_area.bottom))
+        if (y > static_cast<s32>(area.bottom))
           continue;
 
         DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-          cmd, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+          cmd, area, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
       }
     }
     else
@@ -583,14 +1044,14 @@ void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd,
       {
         s32 y = TruncateGPUVertexPosition(yi);
 
-        if (y > static_cast<s32>(m_drawing_area.bottom))
+        if (y > static_cast<s32>(area.bottom))
           break;
 
-        if (y >= static_cast<s32>(m_drawing_area.top))
+        if (y >= static_cast<s32>(area.top))
         {
 
           DrawSpan<shading_enable, texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
-            cmd, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
+            cmd, area, yi, GetPolyXFP_Int(lc), GetPolyXFP_Int(rc), ig, idl);
         }
 
         yi++;
@@ -635,8 +1096,8 @@ static ALWAYS_INLINE_RELEASE s64 LineDivide(s64 delta, s32 dk)
 }
 
 template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBackendDrawLineCommand::Vertex* p0,
-                              const GPUBackendDrawLineCommand::Vertex* p1)
+void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& area,
+                              const GPUBackendDrawLineCommand::Vertex* p0, const GPUBackendDrawLineCommand::Vertex* p1)
 {
   const s32 i_dx = std::abs(p1->x - p0->x);
   const s32 i_dy = std::abs(p1->y - p0->y);
@@ -696,8 +1157,8 @@ void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBac
     const s32 y = (cur_point.y >> Line_XY_FractBits) & 2047;
 
     if ((!cmd->params.interlaced_rendering || cmd->params.active_line_lsb != (Truncate8(static_cast<u32>(y)) & 1u)) &&
-        x >= static_cast<s32>(m_drawing_area.left) && x <= static_cast<s32>(m_drawing_area.right) &&
-        y >= static_cast<s32>(m_drawing_area.top) && y <= static_cast<s32>(m_drawing_area.bottom))
+        x >= static_cast<s32>(area.left) && x <= static_cast<s32>(area.right) && y >= static_cast<s32>(area.top) &&
+        y <= static_cast<s32>(area.bottom))
     {
       const u8 r = shading_enable ? static_cast<u8>(cur_point.r >> Line_RGB_FractBits) : p0->r;
       const u8 g = shading_enable ? static_cast<u8>(cur_point.g >> Line_RGB_FractBits) : p0->g;
@@ -873,10 +1334,244 @@ void GPU_SW_Backend::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wi
   }
 }
 
-void GPU_SW_Backend::FlushRender() {}
+void GPU_SW_Backend::FlushRender()
+{
+  if (!IsUsingRasterThreads())
+    return;
+
+  if (m_raster_batches[m_raster_record_batch].size > 0)
+    SubmitRasterBatch();
+
+  WaitForRasterThreads();
+}
 
 void GPU_SW_Backend::DrawingAreaChanged() {}
 
+void GPU_SW_Backend::StartRasterThreads(u32 count)
+{
+  count = std::min<u32>(count, MAX_RASTER_THREADS);
+  if (count <= 1)
+    return;
+
+  m_raster_threads_shutdown = false;
+  m_raster_threads_busy = 0;
+  m_raster_batch_counter = 0;
+  m_raster_record_batch = 0;
+  m_raster_execute_batch = 0;
+  for (RasterBatch& batch : m_raster_batches)
+    batch.size = 0;
+  m_raster_dirty_rect.SetInvalid();
+  m_raster_texture_rect.SetInvalid();
+
+  m_raster_threads.reserve(count);
+  for (u32 i = 0; i < count; i++)
+  {
+    Threading::Thread& thread = m_raster_threads.emplace_back();
+    thread.Start([this, i]() { RasterThreadEntryPoint(i); });
+  }
+
+  Log_InfoPrintf("Started %u raster threads.", count);
+}
+
+void GPU_SW_Backend::StopRasterThreads()
+{
+  if (m_raster_threads.empty())
+    return;
+
+  FlushRender();
+
+  {
+    std::unique_lock<std::mutex> lock(m_raster_mutex);
+    m_raster_threads_shutdown = true;
+    m_raster_work_cv.notify_all();
+  }
+
+  for (Threading::Thread& thread : m_raster_threads)
+    thread.Join();
+  m_raster_threads.clear();
+  Log_InfoPrint("Raster threads stopped.");
+}
+
+u64 GPU_SW_Backend::GetRasterThreadsCPUTime() const
+{
+  u64 time = 0;
+  for (const Threading::Thread& thread : m_raster_threads)
+    time += thread.GetCPUTime();
+
+  return time;
+}
+
+void GPU_SW_Backend::RasterThreadEntryPoint(u32 index)
+{
+  Threading::SetNameOfCurrentThread(TinyString::FromFormat("Raster Thread %u", index));
+
+  u64 last_batch_counter = 0;
+  std::unique_lock<std::mutex> lock(m_raster_mutex);
+  for (;;)
+  {
+    m_raster_work_cv.wait(lock, [this, last_batch_counter]() {
+      return m_raster_threads_shutdown || m_raster_batch_counter != last_batch_counter;
+    });
+    if (m_raster_threads_shutdown)
+      break;
+
+    last_batch_counter = m_raster_batch_counter;
+    const RasterBatch& batch = m_raster_batches[m_raster_execute_batch];
+    lock.unlock();
+
+    const Common::Rectangle<u32> area = GetRasterThreadArea(batch.drawing_area, index);
+    if (area.Valid())
+      ExecuteRasterBatch(batch, area);
+
+    lock.lock();
+    if ((--m_raster_threads_busy) == 0)
+      m_raster_done_cv.notify_one();
+  }
+}
+
+Common::Rectangle<u32> GPU_SW_Backend::GetRasterThreadArea(const Common::Rectangle<u32>& drawing_area, u32 index) const
+{
+  // Each thread gets a contiguous band of the drawing area. Bands are inclusive, like the drawing area itself.
+  const u32 num_threads = static_cast<u32>(m_raster_threads.size());
+  const u32 height = drawing_area.bottom - drawing_area.top + 1;
+  const u32 band_height = (height + num_threads - 1) / num_threads;
+  const u32 top = drawing_area.top + (band_height * index);
+  const u32 bottom = std::min(top + band_height - 1, drawing_area.bottom);
+  return Common::Rectangle<u32>(drawing_area.left, top, drawing_area.right, bottom);
+}
+
+Common::Rectangle<u32> GPU_SW_Backend::GetTextureSourceRectangle(const GPUBackendDrawCommand* cmd)
+{
+  if (!cmd->rc.texture_enable)
+    return {};
+
+  Common::Rectangle<u32> rect = cmd->draw_mode.GetTexturePageRectangle();
+  if (cmd->draw_mode.IsUsingPalette())
+  {
+    const u32 palette_width = (cmd->draw_mode.texture_mode == GPUTextureMode::Palette4Bit) ? 16 : 256;
+    rect.Include(
+      Common::Rectangle<u32>::FromExtents(cmd->palette.GetXBase(), cmd->palette.GetYBase(), palette_width, 1));
+  }
+
+  // Texture and palette reads wrap around horizontally.
+  if (rect.right > VRAM_WIDTH)
+  {
+    rect.left = 0;
+    rect.right = VRAM_WIDTH;
+  }
+
+  return rect;
+}
+
+void GPU_SW_Backend::QueueRasterCommand(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& bounds)
+{
+  const Common::Rectangle<u32> texture_rect = GetTextureSourceRectangle(cmd);
+
+  // Primitives which sample from their own output depend on the order rows are drawn in, so they can't be split.
+  // Oversized polylines won't fit in a batch either, so just draw them on this thread.
+  if (cmd->size > RASTER_BATCH_SIZE || texture_rect.Intersects(bounds))
+  {
+    FlushRender();
+    switch (cmd->type)
+    {
+      case GPUBackendCommandType::DrawPolygon:
+        RasterizePolygon(static_cast<const GPUBackendDrawPolygonCommand*>(cmd), m_drawing_area);
+        break;
+      case GPUBackendCommandType::DrawRectangle:
+        RasterizeRectangle(static_cast<const GPUBackendDrawRectangleCommand*>(cmd), m_drawing_area);
+        break;
+      case GPUBackendCommandType::DrawLine:
+        RasterizeLine(static_cast<const GPUBackendDrawLineCommand*>(cmd), m_drawing_area);
+        break;
+      default:
+        break;
+    }
+
+    return;
+  }
+
+  // Threads can be at different points in the batch, so sampling from an area which was drawn to earlier in the batch,
+  // or drawing to an area which was sampled from earlier in the batch, would race. Start a new batch instead.
+  RasterBatch* batch = &m_raster_batches[m_raster_record_batch];
+  if ((batch->size + cmd->size) > RASTER_BATCH_SIZE || texture_rect.Intersects(m_raster_dirty_rect) ||
+      bounds.Intersects(m_raster_texture_rect))
+  {
+    SubmitRasterBatch();
+    batch = &m_raster_batches[m_raster_record_batch];
+  }
+
+  std::memcpy(&batch->data[batch->size], cmd, cmd->size);
+  batch->size += cmd->size;
+  if (bounds.HasExtents())
+    m_raster_dirty_rect.Include(bounds);
+  if (texture_rect.HasExtents())
+    m_raster_texture_rect.Include(texture_rect);
+
+  // Kick the threads off early if they're idle, that way we overlap with the GPU thread.
+  if (batch->size >= RASTER_BATCH_SUBMIT_THRESHOLD)
+  {
+    std::unique_lock<std::mutex> lock(m_raster_mutex);
+    if (m_raster_threads_busy == 0)
+    {
+      lock.unlock();
+      SubmitRasterBatch();
+    }
+  }
+}
+
+void GPU_SW_Backend::ExecuteRasterBatch(const RasterBatch& batch, const Common::Rectangle<u32>& area)
+{
+  const u8* data = batch.data.data();
+  for (u32 offset = 0; offset < batch.size;)
+  {
+    const GPUBackendCommand* cmd = reinterpret_cast<const GPUBackendCommand*>(&data[offset]);
+    offset += cmd->size;
+
+    switch (cmd->type)
+    {
+      case GPUBackendCommandType::DrawPolygon:
+        RasterizePolygon(static_cast<const GPUBackendDrawPolygonCommand*>(cmd), area);
+        break;
+      case GPUBackendCommandType::DrawRectangle:
+        RasterizeRectangle(static_cast<const GPUBackendDrawRectangleCommand*>(cmd), area);
+        break;
+      case GPUBackendCommandType::DrawLine:
+        RasterizeLine(static_cast<const GPUBackendDrawLineCommand*>(cmd), area);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void GPU_SW_Backend::SubmitRasterBatch()
+{
+  // Previous batch must be complete before the next one starts, otherwise threads could be working on different ones.
+  WaitForRasterThreads();
+
+  RasterBatch& batch = m_raster_batches[m_raster_record_batch];
+  batch.drawing_area = m_drawing_area;
+
+  {
+    std::unique_lock<std::mutex> lock(m_raster_mutex);
+    m_raster_execute_batch = m_raster_record_batch;
+    m_raster_threads_busy = static_cast<u32>(m_raster_threads.size());
+    m_raster_batch_counter++;
+    m_raster_work_cv.notify_all();
+  }
+
+  m_raster_record_batch ^= 1;
+  m_raster_batches[m_raster_record_batch].size = 0;
+  m_raster_dirty_rect.SetInvalid();
+  m_raster_texture_rect.SetInvalid();
+}
+
+void GPU_SW_Backend::WaitForRasterThreads()
+{
+  std::unique_lock<std::mutex> lock(m_raster_mutex);
+  m_raster_done_cv.wait(lock, [this]() { return m_raster_threads_busy == 0; });
+}
+
 GPU_SW_Backend::DrawLineFunction GPU_SW_Backend::GetDrawLineFunction(bool shading_enable, bool transparency_enable,
                                                                      bool dithering_enable)
 {
@@ -2,11 +2,18 @@
 // SPDX-License-Identifier: (GPL-3.0 OR CC-BY-NC-ND-4.0)
 
 #pragma once
+#include "common/platform.h"
 #include "gpu_backend.h"
 #include <array>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <vector>
 
+#if defined(CPU_X64) || defined(CPU_AARCH64)
+#define USE_VECTOR_SPANS 1
+#endif
+
 class GPU_SW_Backend final : public GPUBackend
 {
 public:
@@ -14,7 +21,12 @@ public:
   ~GPU_SW_Backend() override;
 
   bool Initialize(bool force_thread) override;
+  void UpdateSettings() override;
   void Reset(bool clear_vram) override;
+  void Shutdown() override;
+
+  /// Returns the CPU time used by the raster threads, in thread ticks.
+  u64 GetRasterThreadsCPUTime() const;
 
   ALWAYS_INLINE_RELEASE u16 GetPixel(const u32 x, const u32 y) const { return m_vram[VRAM_WIDTH * y + x]; }
   ALWAYS_INLINE_RELEASE const u16* GetPixelPtr(const u32 x, const u32 y) const { return &m_vram[VRAM_WIDTH * y + x]; }
@@ -26,6 +38,9 @@ public:
   using DitherLUT = std::array<std::array<std::array<u8, 512>, DITHER_MATRIX_SIZE>, DITHER_MATRIX_SIZE>;
   static constexpr DitherLUT ComputeDitherLUT();
 
+  // Number of pixels shaded at once by the vector span kernel.
+  static constexpr u32 SPAN_VECTOR_WIDTH = 8;
+
 protected:
   union VRAMPixel
   {
@@ -101,14 +116,28 @@ protected:
   //////////////////////////////////////////////////////////////////////////
   // Rasterization
   //////////////////////////////////////////////////////////////////////////
+  u16 GetTexturePixel(const GPUBackendDrawCommand* cmd, u8 texcoord_x, u8 texcoord_y) const;
+
   template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
   void ShadePixel(const GPUBackendDrawCommand* cmd, u32 x, u32 y, u8 color_r, u8 color_g, u8 color_b, u8 texcoord_x,
                   u8 texcoord_y);
 
+#ifdef USE_VECTOR_SPANS
+  /// Shades SPAN_VECTOR_WIDTH consecutive pixels in a row, which must all be inside the drawing area.
+  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
+  void ShadePixels(const GPUBackendDrawCommand* cmd, u32 x, u32 y, const u16* color_r, const u16* color_g,
+                   const u16* color_b, const u8* texcoord_x, const u8* texcoord_y);
+#endif
+
+  void RasterizePolygon(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area);
+  void RasterizeRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& area);
+  void RasterizeLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& area);
+
   template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd);
+  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, const Common::Rectangle<u32>& area);
 
-  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd);
+  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd,
+                                                         const Common::Rectangle<u32>& area);
   DrawRectangleFunction GetDrawRectangleFunction(bool texture_enable, bool raw_texture_enable,
                                                  bool transparency_enable);
 
@@ -142,15 +171,17 @@ protected:
 
   template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
            bool dithering_enable>
-  void DrawSpan(const GPUBackendDrawPolygonCommand* cmd, s32 y, s32 x_start, s32 x_bound, i_group ig,
-                const i_deltas& idl);
+  void DrawSpan(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area, s32 y, s32 x_start,
+                s32 x_bound, i_group ig, const i_deltas& idl);
 
   template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
            bool dithering_enable>
-  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const GPUBackendDrawPolygonCommand::Vertex* v0,
-                    const GPUBackendDrawPolygonCommand::Vertex* v1, const GPUBackendDrawPolygonCommand::Vertex* v2);
+  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, const Common::Rectangle<u32>& area,
+                    const GPUBackendDrawPolygonCommand::Vertex* v0, const GPUBackendDrawPolygonCommand::Vertex* v1,
+                    const GPUBackendDrawPolygonCommand::Vertex* v2);
 
   using DrawTriangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawPolygonCommand* cmd,
+                                                        const Common::Rectangle<u32>& area,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v0,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v1,
                                                         const GPUBackendDrawPolygonCommand::Vertex* v2);
@@ -158,13 +189,66 @@ protected:
                                                bool transparency_enable, bool dithering_enable);
 
   template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-  void DrawLine(const GPUBackendDrawLineCommand* cmd, const GPUBackendDrawLineCommand::Vertex* p0,
-                const GPUBackendDrawLineCommand::Vertex* p1);
+  void DrawLine(const GPUBackendDrawLineCommand* cmd, const Common::Rectangle<u32>& area,
+                const GPUBackendDrawLineCommand::Vertex* p0, const GPUBackendDrawLineCommand::Vertex* p1);
 
   using DrawLineFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawLineCommand* cmd,
+                                                    const Common::Rectangle<u32>& area,
                                                     const GPUBackendDrawLineCommand::Vertex* p0,
                                                     const GPUBackendDrawLineCommand::Vertex* p1);
   DrawLineFunction GetDrawLineFunction(bool shading_enable, bool transparency_enable, bool dithering_enable);
 
+  //////////////////////////////////////////////////////////////////////////
+  // Multi-threaded rasterization
+  //////////////////////////////////////////////////////////////////////////
+  enum : u32
+  {
+    MAX_RASTER_THREADS = 32,
+    RASTER_BATCH_SIZE = 256 * 1024,
+    RASTER_BATCH_SUBMIT_THRESHOLD = 16 * 1024,
+  };
+
+  // Draw commands are copied into a batch, and each raster thread executes the whole batch clipped to its own band
+  // of scanlines. Batches are executed one at a time, so the boundary between two batches acts as a barrier.
+  struct RasterBatch
+  {
+    FixedHeapArray<u8, RASTER_BATCH_SIZE> data;
+    u32 size = 0;
+    Common::Rectangle<u32> drawing_area{};
+  };
+
+  ALWAYS_INLINE bool IsUsingRasterThreads() const { return !m_raster_threads.empty(); }
+
+  void StartRasterThreads(u32 count);
+  void StopRasterThreads();
+  void RasterThreadEntryPoint(u32 index);
+
+  /// Returns the band of the drawing area which the specified raster thread is responsible for.
+  Common::Rectangle<u32> GetRasterThreadArea(const Common::Rectangle<u32>& drawing_area, u32 index) const;
+
+  /// Returns the area of VRAM which the command may sample from, covering both the texture page and palette.
+  static Common::Rectangle<u32> GetTextureSourceRectangle(const GPUBackendDrawCommand* cmd);
+
+  void QueueRasterCommand(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& bounds);
+  void ExecuteRasterBatch(const RasterBatch& batch, const Common::Rectangle<u32>& area);
+  void SubmitRasterBatch();
+  void WaitForRasterThreads();
+
   std::array<u16, VRAM_WIDTH * VRAM_HEIGHT> m_vram;
+
+  std::vector<Threading::Thread> m_raster_threads;
+  std::array<RasterBatch, 2> m_raster_batches;
+  u32 m_raster_record_batch = 0;
+  u32 m_raster_execute_batch = 0;
+
+  // Union of the areas drawn to and sampled from by commands in the batch being recorded.
+  Common::Rectangle<u32> m_raster_dirty_rect;
+  Common::Rectangle<u32> m_raster_texture_rect;
+
+  std::mutex m_raster_mutex;
+  std::condition_variable m_raster_work_cv;
+  std::condition_variable m_raster_done_cv;
+  u64 m_raster_batch_counter = 0;
+  u32 m_raster_threads_busy = 0;
+  bool m_raster_threads_shutdown = false;
 };
@@ -20,6 +20,10 @@ void WriteRegister(u32 index, u32 value);
 // use with care, direct register access
 u32* GetRegisterPtr(u32 index);
 
+// for the recompiler, which reads these at runtime
+const s32* GetProjectionXScale(); // numerator, denominator
+const u8* GetUNRTable();
+
 void ExecuteInstruction(u32 inst_bits);
 
 using InstructionImpl = void (*)(Instruction);
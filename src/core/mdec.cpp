@@ -4,7 +4,10 @@
 #include "mdec.h"
 #include "common/bitfield.h"
 #include "common/fifo_queue.h"
+#include "common/file_system.h"
 #include "common/log.h"
+#include "common/platform.h"
+#include "common/threading.h"
 #include "cpu_core.h"
 #include "dma.h"
 #include "host.h"
@@ -13,7 +16,16 @@
 #include "system.h"
 #include "util/state_wrapper.h"
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#endif
 
 Log_SetChannel(MDEC);
 
@@ -100,17 +112,32 @@ static void HandleSetScaleCommand();
 
 static bool DecodeMonoMacroblock();
 static bool DecodeColoredMacroblock();
+static void IDCTBlocks(u32 block_mask);
+static void ConvertMacroblock(DataOutputDepth depth, bool output_signed);
 static void ScheduleBlockCopyOut(TickCount ticks);
 static void CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late);
 
+static void StartDecodeThread();
+static void StopDecodeThread();
+static void DecodeThreadEntryPoint();
+static void QueueThreadedDecode(u32 idct_blocks);
+static void WaitForThreadedDecode();
+static void FlushThreadedDecode();
+
 // from nocash spec
 static bool rl_decode_block(s16* blk, const u8* qt);
 static void IDCT(s16* blk);
 static void IDCT_New(s16* blk);
+static void IDCT_New_Reference(s16* blk);
 static void IDCT_Old(s16* blk);
 static void yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
-                       const std::array<s16, 64>& Yblk);
+                       const std::array<s16, 64>& Yblk, bool output_signed);
+static void yuv_to_rgb_Reference(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
+                                 const std::array<s16, 64>& Yblk, bool output_signed);
 static void y_to_mono(const std::array<s16, 64>& Yblk);
+static void y_to_mono_Reference(const std::array<s16, 64>& Yblk);
+
+static void WriteCapture(const u32* words, u32 word_count);
 
 static StatusRegister s_status = {};
 static bool s_enable_dma_in = false;
@@ -137,6 +164,25 @@ alignas(16) static std::array<u32, 256> s_block_rgb{};
 static std::unique_ptr<TimingEvent> s_block_copy_out_event;
 
 static u32 s_total_blocks_decoded = 0;
+
+// When the decode thread is running, IDCT is deferred until the whole macroblock has been read from the FIFO. The
+// worker then does the IDCT and colour conversion while the copy out event is pending, and owns s_blocks/s_block_rgb
+// until WaitForThreadedDecode() returns.
+static std::thread s_decode_thread;
+static std::mutex s_decode_mutex;
+static std::condition_variable s_decode_work_cv;
+static std::condition_variable s_decode_done_cv;
+static std::atomic_bool s_decode_busy{false};
+static bool s_decode_thread_shutdown = false;
+static u32 s_decode_idct_blocks = 0;
+static DataOutputDepth s_decode_output_depth = DataOutputDepth_4Bit;
+static bool s_decode_output_signed = false;
+
+// Blocks which have been run-length decoded, but still need an IDCT. Only used with the decode thread.
+static u32 s_pending_idct_blocks = 0;
+
+// Everything written to the data register is captured here, for use with DecodeCapture().
+static std::FILE* s_capture_file = nullptr;
 } // namespace MDEC
 
 void MDEC::Initialize()
@@ -145,10 +191,14 @@ void MDEC::Initialize()
     TimingEvents::CreateTimingEvent("MDEC Block Copy Out", 1, 1, &MDEC::CopyOutBlock, nullptr, false);
   s_total_blocks_decoded = 0;
   Reset();
+
+  if (g_settings.mdec_use_thread)
+    StartDecodeThread();
 }
 
 void MDEC::Shutdown()
 {
+  StopDecodeThread();
   s_block_copy_out_event.reset();
 }
 
@@ -160,6 +210,9 @@ void MDEC::Reset()
 
 bool MDEC::DoState(StateWrapper& sw)
 {
+  // Save states always contain the IDCT'ed blocks and the complete output block.
+  FlushThreadedDecode();
+
   sw.Do(&s_status.bits);
   sw.Do(&s_enable_dma_in);
   sw.Do(&s_enable_dma_out);
@@ -266,6 +319,9 @@ void MDEC::DMAWrite(const u32* words, u32 word_count)
   }
 
   const u32 halfwords_to_write = std::min(word_count * 2, s_data_in_fifo.GetSpace() & ~u32(2));
+  if (UNLIKELY(s_capture_file))
+    WriteCapture(words, halfwords_to_write / 2);
+
   s_data_in_fifo.PushRange(reinterpret_cast<const u16*>(words), halfwords_to_write);
   Execute();
 }
@@ -277,6 +333,9 @@ bool MDEC::HasPendingBlockCopyOut()
 
 void MDEC::SoftReset()
 {
+  WaitForThreadedDecode();
+  s_pending_idct_blocks = 0;
+
   s_status.bits = 0;
   s_enable_dma_in = false;
   s_enable_dma_out = false;
@@ -296,6 +355,7 @@ void MDEC::ResetDecoder()
   s_current_block = 0;
   s_current_coefficient = 64;
   s_current_q_scale = 0;
+  s_pending_idct_blocks = 0;
 }
 
 void MDEC::UpdateStatus()
@@ -348,6 +408,9 @@ void MDEC::WriteCommandRegister(u32 value)
 {
   Log_TracePrintf("MDEC command/data register <- 0x%08X", value);
 
+  if (UNLIKELY(s_capture_file))
+    WriteCapture(&value, 1);
+
   s_data_in_fifo.Push(Truncate16(value));
   s_data_in_fifo.Push(Truncate16(value >> 16));
 
@@ -499,13 +562,19 @@ bool MDEC::DecodeMonoMacroblock()
   if (!rl_decode_block(s_blocks[0].data(), s_iq_y.data()))
     return false;
 
-  IDCT(s_blocks[0].data());
-
   Log_DebugPrintf("Decoded mono macroblock, %u words remaining", s_remaining_halfwords / 2);
   ResetDecoder();
   s_state = State::WritingMacroblock;
 
-  y_to_mono(s_blocks[0]);
+  if (s_decode_thread.joinable())
+  {
+    QueueThreadedDecode(1u << 0);
+  }
+  else
+  {
+    IDCT(s_blocks[0].data());
+    ConvertMacroblock(s_status.data_output_depth, s_status.data_output_signed);
+  }
 
   ScheduleBlockCopyOut(TICKS_PER_BLOCK * 6);
 
@@ -520,7 +589,10 @@ bool MDEC::DecodeColoredMacroblock()
     if (!rl_decode_block(s_blocks[s_current_block].data(), (s_current_block >= 2) ? s_iq_y.data() : s_iq_uv.data()))
       return false;
 
-    IDCT(s_blocks[s_current_block].data());
+    if (s_decode_thread.joinable())
+      s_pending_idct_blocks |= (1u << s_current_block);
+    else
+      IDCT(s_blocks[s_current_block].data());
   }
 
   if (!s_data_out_fifo.IsEmpty())
@@ -528,19 +600,45 @@ bool MDEC::DecodeColoredMacroblock()
 
   // done decoding
   Log_DebugPrintf("Decoded colored macroblock, %u words remaining", s_remaining_halfwords / 2);
+  const u32 idct_blocks = s_pending_idct_blocks;
   ResetDecoder();
   s_state = State::WritingMacroblock;
 
-  yuv_to_rgb(0, 0, s_blocks[0], s_blocks[1], s_blocks[2]);
-  yuv_to_rgb(8, 0, s_blocks[0], s_blocks[1], s_blocks[3]);
-  yuv_to_rgb(0, 8, s_blocks[0], s_blocks[1], s_blocks[4]);
-  yuv_to_rgb(8, 8, s_blocks[0], s_blocks[1], s_blocks[5]);
+  if (s_decode_thread.joinable())
+    QueueThreadedDecode(idct_blocks);
+  else
+    ConvertMacroblock(s_status.data_output_depth, s_status.data_output_signed);
+
   s_total_blocks_decoded += 4;
 
   ScheduleBlockCopyOut(TICKS_PER_BLOCK * 6);
   return true;
 }
 
+void MDEC::IDCTBlocks(u32 block_mask)
+{
+  for (u32 i = 0; i < NUM_BLOCKS; i++)
+  {
+    if (block_mask & (1u << i))
+      IDCT(s_blocks[i].data());
+  }
+}
+
+void MDEC::ConvertMacroblock(DataOutputDepth depth, bool output_signed)
+{
+  if (depth <= DataOutputDepth_8Bit)
+  {
+    y_to_mono(s_blocks[0]);
+  }
+  else
+  {
+    yuv_to_rgb(0, 0, s_blocks[0], s_blocks[1], s_blocks[2], output_signed);
+    yuv_to_rgb(8, 0, s_blocks[0], s_blocks[1], s_blocks[3], output_signed);
+    yuv_to_rgb(0, 8, s_blocks[0], s_blocks[1], s_blocks[4], output_signed);
+    yuv_to_rgb(8, 8, s_blocks[0], s_blocks[1], s_blocks[5], output_signed);
+  }
+}
+
 void MDEC::ScheduleBlockCopyOut(TickCount ticks)
 {
   DebugAssert(!HasPendingBlockCopyOut());
@@ -553,6 +651,7 @@ void MDEC::CopyOutBlock(void* param, TickCount ticks, TickCount ticks_late)
 {
   Assert(s_state == State::WritingMacroblock);
   s_block_copy_out_event->Deactivate();
+  WaitForThreadedDecode();
 
   switch (s_status.data_output_depth)
   {
@@ -770,15 +869,113 @@ void MDEC::IDCT(s16* blk)
     IDCT_New(blk);
 }
 
+#if defined(CPU_X64)
+
+static ALWAYS_INLINE void Transpose8x8(__m128i rows[8])
+{
+  const __m128i a0 = _mm_unpacklo_epi16(rows[0], rows[1]);
+  const __m128i a1 = _mm_unpackhi_epi16(rows[0], rows[1]);
+  const __m128i a2 = _mm_unpacklo_epi16(rows[2], rows[3]);
+  const __m128i a3 = _mm_unpackhi_epi16(rows[2], rows[3]);
+  const __m128i a4 = _mm_unpacklo_epi16(rows[4], rows[5]);
+  const __m128i a5 = _mm_unpackhi_epi16(rows[4], rows[5]);
+  const __m128i a6 = _mm_unpacklo_epi16(rows[6], rows[7]);
+  const __m128i a7 = _mm_unpackhi_epi16(rows[6], rows[7]);
+  const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+  const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+  const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+  const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+  const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+  const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+  const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+  const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+  rows[0] = _mm_unpacklo_epi64(b0, b4);
+  rows[1] = _mm_unpackhi_epi64(b0, b4);
+  rows[2] = _mm_unpacklo_epi64(b1, b5);
+  rows[3] = _mm_unpackhi_epi64(b1, b5);
+  rows[4] = _mm_unpacklo_epi64(b2, b6);
+  rows[5] = _mm_unpackhi_epi64(b2, b6);
+  rows[6] = _mm_unpacklo_epi64(b3, b7);
+  rows[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+// (sum + 0xfff) / 0x2000, rounding towards zero like the scalar division.
+static ALWAYS_INLINE __m128i IDCTRoundShift(__m128i sum)
+{
+  const __m128i t = _mm_add_epi32(sum, _mm_set1_epi32(0xfff));
+  return _mm_srai_epi32(_mm_add_epi32(t, _mm_and_si128(_mm_srai_epi32(t, 31), _mm_set1_epi32(0x1fff))), 13);
+}
+
+// rows[y] = sum(z) rows[z][y] * scale[z], with the input already transposed. Coefficients are interleaved in pairs
+// so that each madd handles two values of z.
+static ALWAYS_INLINE void IDCTPass(__m128i rows[8], const __m128i scale_lo[4], const __m128i scale_hi[4])
+{
+  for (u32 y = 0; y < 8; y++)
+  {
+    const __m128i in = rows[y];
+    __m128i sum_lo = _mm_setzero_si128();
+    __m128i sum_hi = _mm_setzero_si128();
+#define IDCT_PAIR(k, shuffle)                                                                                          \
+  {                                                                                                                    \
+    const __m128i pair = _mm_shuffle_epi32(in, shuffle);                                                               \
+    sum_lo = _mm_add_epi32(sum_lo, _mm_madd_epi16(pair, scale_lo[k]));                                                 \
+    sum_hi = _mm_add_epi32(sum_hi, _mm_madd_epi16(pair, scale_hi[k]));                                                 \
+  }
+    IDCT_PAIR(0, 0x00);
+    IDCT_PAIR(1, 0x55);
+    IDCT_PAIR(2, 0xAA);
+    IDCT_PAIR(3, 0xFF);
+#undef IDCT_PAIR
+
+    // Intermediate values are guaranteed to fit in 16 bits, and the final clamp is narrower than the saturation.
+    rows[y] = _mm_packs_epi32(IDCTRoundShift(sum_lo), IDCTRoundShift(sum_hi));
+  }
+}
+
+#endif
+
 void MDEC::IDCT_New(s16* blk)
+{
+#if defined(CPU_X64)
+  // Both passes are (transpose(in) * scale), so the whole thing is done as two transposes and two passes.
+  __m128i scale_lo[4], scale_hi[4];
+  for (u32 k = 0; k < 4; k++)
+  {
+    // scale / 8, rounding towards zero.
+    __m128i s0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s_scale_table[(k * 2) * 8]));
+    __m128i s1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&s_scale_table[(k * 2 + 1) * 8]));
+    s0 = _mm_srai_epi16(_mm_add_epi16(s0, _mm_and_si128(_mm_srai_epi16(s0, 15), _mm_set1_epi16(7))), 3);
+    s1 = _mm_srai_epi16(_mm_add_epi16(s1, _mm_and_si128(_mm_srai_epi16(s1, 15), _mm_set1_epi16(7))), 3);
+    scale_lo[k] = _mm_unpacklo_epi16(s0, s1);
+    scale_hi[k] = _mm_unpackhi_epi16(s0, s1);
+  }
+
+  __m128i rows[8];
+  for (u32 i = 0; i < 8; i++)
+    rows[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&blk[i * 8]));
+
+  Transpose8x8(rows);
+  IDCTPass(rows, scale_lo, scale_hi);
+  Transpose8x8(rows);
+  IDCTPass(rows, scale_lo, scale_hi);
+
+  for (u32 i = 0; i < 8; i++)
+  {
+    const __m128i clamped = _mm_min_epi16(_mm_max_epi16(rows[i], _mm_set1_epi16(-128)), _mm_set1_epi16(127));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&blk[i * 8]), clamped);
+  }
+#else
+  IDCT_New_Reference(blk);
+#endif
+}
+
+void MDEC::IDCT_New_Reference(s16* blk)
 {
   std::array<s32, 64> temp;
   for (u32 x = 0; x < 8; x++)
   {
     for (u32 y = 0; y < 8; y++)
     {
-      // TODO: We could alter zigzag and invert scale_table to get these in row-major order,
-      // in which case we could do optimize this to a vector multiply.
       s32 sum = 0;
       for (u32 z = 0; z < 8; z++)
         sum += s32(blk[y + z * 8]) * s32(s_scale_table[x + z * 8] / 8);
@@ -825,9 +1022,63 @@ void MDEC::IDCT_Old(s16* blk)
 }
 
 void MDEC::yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
-                      const std::array<s16, 64>& Yblk)
+                      const std::array<s16, 64>& Yblk, bool output_signed)
+{
+#if defined(CPU_X64)
+  // The float math is done in the same order as the scalar version, so the results are identical.
+  const s16 addval = output_signed ? 0 : 0x80;
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i v_addval = _mm_set1_epi16(addval);
+  const __m128i v_min = _mm_set1_epi16(-128);
+  const __m128i v_max = _mm_set1_epi16(127);
+  for (u32 y = 0; y < 8; y++)
+  {
+    // Each chroma sample covers two pixels.
+    const u32 chroma_offset = (xx / 2) + ((y + yy) / 2) * 8;
+    const __m128i cr = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&Crblk[chroma_offset]));
+    const __m128i cb = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&Cbblk[chroma_offset]));
+    const __m128 crf = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(cr, cr), 16));
+    const __m128 cbf = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(cb, cb), 16));
+
+    const __m128i g4 = _mm_cvttps_epi32(
+      _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-0.3437f), cbf), _mm_mul_ps(_mm_set1_ps(-0.7143f), crf)));
+    const __m128i r4 = _mm_cvttps_epi32(_mm_mul_ps(_mm_set1_ps(1.402f), crf));
+    const __m128i b4 = _mm_cvttps_epi32(_mm_mul_ps(_mm_set1_ps(1.772f), cbf));
+    const __m128i r16 = _mm_packs_epi32(r4, r4);
+    const __m128i g16 = _mm_packs_epi32(g4, g4);
+    const __m128i b16 = _mm_packs_epi32(b4, b4);
+
+    const __m128i Y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Yblk[y * 8]));
+    const __m128i R =
+      _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(Y, _mm_unpacklo_epi16(r16, r16)), v_min), v_max),
+                    v_addval);
+    const __m128i G =
+      _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(Y, _mm_unpacklo_epi16(g16, g16)), v_min), v_max),
+                    v_addval);
+    const __m128i B =
+      _mm_add_epi16(_mm_min_epi16(_mm_max_epi16(_mm_add_epi16(Y, _mm_unpacklo_epi16(b16, b16)), v_min), v_max),
+                    v_addval);
+
+    const __m128i rgb_lo =
+      _mm_or_si128(_mm_or_si128(_mm_unpacklo_epi16(R, zero), _mm_slli_epi32(_mm_unpacklo_epi16(G, zero), 8)),
+                   _mm_slli_epi32(_mm_unpacklo_epi16(B, zero), 16));
+    const __m128i rgb_hi =
+      _mm_or_si128(_mm_or_si128(_mm_unpackhi_epi16(R, zero), _mm_slli_epi32(_mm_unpackhi_epi16(G, zero), 8)),
+                   _mm_slli_epi32(_mm_unpackhi_epi16(B, zero), 16));
+    u32* out_ptr = &s_block_rgb[xx + ((y + yy) * 16)];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out_ptr), rgb_lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out_ptr + 4), rgb_hi);
+  }
+#else
+  yuv_to_rgb_Reference(xx, yy, Crblk, Cbblk, Yblk, output_signed);
+#endif
+}
+
+void MDEC::yuv_to_rgb_Reference(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const std::array<s16, 64>& Cbblk,
+                                const std::array<s16, 64>& Yblk, bool output_signed)
 {
-  const s16 addval = s_status.data_output_signed ? 0 : 0x80;
+  const s16 addval = output_signed ? 0 : 0x80;
+
   for (u32 y = 0; y < 8; y++)
   {
     for (u32 x = 0; x < 8; x++)
@@ -852,6 +1103,24 @@ void MDEC::yuv_to_rgb(u32 xx, u32 yy, const std::array<s16, 64>& Crblk, const st
 }
 
 void MDEC::y_to_mono(const std::array<s16, 64>& Yblk)
+{
+#if defined(CPU_X64)
+  const __m128i zero = _mm_setzero_si128();
+  for (u32 i = 0; i < 64; i += 8)
+  {
+    // SignExtendN<10>() is a no-op here due to integer promotion, so the reference only clamps.
+    __m128i Y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Yblk[i]));
+    Y = _mm_min_epi16(_mm_max_epi16(Y, _mm_set1_epi16(-128)), _mm_set1_epi16(127));
+    Y = _mm_and_si128(_mm_add_epi16(Y, _mm_set1_epi16(128)), _mm_set1_epi16(0xFF));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&s_block_rgb[i]), _mm_unpacklo_epi16(Y, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&s_block_rgb[i + 4]), _mm_unpackhi_epi16(Y, zero));
+  }
+#else
+  y_to_mono_Reference(Yblk);
+#endif
+}
+
+void MDEC::y_to_mono_Reference(const std::array<s16, 64>& Yblk)
 {
   for (u32 i = 0; i < 64; i++)
   {
@@ -893,6 +1162,314 @@ void MDEC::HandleSetScaleCommand()
   std::memcpy(s_scale_table.data(), packed_data.data(), s_scale_table.size() * sizeof(s16));
 }
 
+void MDEC::SetUseThread(bool enabled)
+{
+  if (s_decode_thread.joinable() == enabled)
+    return;
+
+  if (enabled)
+    StartDecodeThread();
+  else
+    StopDecodeThread();
+}
+
+void MDEC::StartDecodeThread()
+{
+  Log_DevPrintf("Starting MDEC decode thread");
+  s_decode_thread_shutdown = false;
+  s_decode_thread = std::thread(&MDEC::DecodeThreadEntryPoint);
+}
+
+void MDEC::StopDecodeThread()
+{
+  if (!s_decode_thread.joinable())
+    return;
+
+  // Any macroblock in the middle of being decoded has to be finished here, since it'll use the inline path after.
+  FlushThreadedDecode();
+
+  {
+    std::unique_lock<std::mutex> lock(s_decode_mutex);
+    s_decode_thread_shutdown = true;
+    s_decode_work_cv.notify_one();
+  }
+
+  s_decode_thread.join();
+  Log_DevPrintf("MDEC decode thread stopped");
+}
+
+void MDEC::DecodeThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("MDEC Decode");
+
+  std::unique_lock<std::mutex> lock(s_decode_mutex);
+  for (;;)
+  {
+    s_decode_work_cv.wait(
+      lock, []() { return s_decode_thread_shutdown || s_decode_busy.load(std::memory_order_relaxed); });
+    if (s_decode_thread_shutdown)
+      break;
+
+    lock.unlock();
+    IDCTBlocks(s_decode_idct_blocks);
+    ConvertMacroblock(s_decode_output_depth, s_decode_output_signed);
+    lock.lock();
+
+    s_decode_busy.store(false, std::memory_order_release);
+    s_decode_done_cv.notify_one();
+  }
+}
+
+void MDEC::QueueThreadedDecode(u32 idct_blocks)
+{
+  DebugAssert(!s_decode_busy.load(std::memory_order_relaxed));
+
+  // The output format is copied, since s_status is updated while the worker is running.
+  std::unique_lock<std::mutex> lock(s_decode_mutex);
+  s_decode_idct_blocks = idct_blocks;
+  s_decode_output_depth = s_status.data_output_depth;
+  s_decode_output_signed = s_status.data_output_signed;
+  s_decode_busy.store(true, std::memory_order_relaxed);
+  s_decode_work_cv.notify_one();
+}
+
+void MDEC::WaitForThreadedDecode()
+{
+  if (!s_decode_busy.load(std::memory_order_acquire))
+    return;
+
+  std::unique_lock<std::mutex> lock(s_decode_mutex);
+  s_decode_done_cv.wait(lock, []() { return !s_decode_busy.load(std::memory_order_acquire); });
+}
+
+void MDEC::FlushThreadedDecode()
+{
+  WaitForThreadedDecode();
+
+  // Finish off any blocks of a partially-received macroblock.
+  IDCTBlocks(s_pending_idct_blocks);
+  s_pending_idct_blocks = 0;
+}
+
+bool MDEC::StartCapture(const char* path)
+{
+  StopCapture();
+
+  s_capture_file = FileSystem::OpenCFile(path, "wb");
+  if (!s_capture_file)
+  {
+    Log_ErrorPrintf("Failed to open MDEC capture file '%s'", path);
+    return false;
+  }
+
+  Log_InfoPrintf("Capturing MDEC input to '%s'", path);
+  return true;
+}
+
+void MDEC::StopCapture()
+{
+  if (!s_capture_file)
+    return;
+
+  std::fclose(s_capture_file);
+  s_capture_file = nullptr;
+}
+
+void MDEC::WriteCapture(const u32* words, u32 word_count)
+{
+  if (std::fwrite(words, sizeof(u32), word_count, s_capture_file) != word_count)
+  {
+    Log_ErrorPrintf("Failed to write MDEC capture, stopping");
+    StopCapture();
+  }
+}
+
+u32 MDEC::DecodeCapture(const u32* words, u32 word_count)
+{
+  u32 blocks_decoded = 0;
+  u32 pos = 0;
+  while (pos < word_count)
+  {
+    const CommandWord cw{words[pos++]};
+    u32 num_words;
+    switch (cw.command)
+    {
+      case Command::SetIqTab:
+        num_words = 16 + (((cw.bits & 1) != 0) ? 16 : 0);
+        break;
+      case Command::SetScale:
+        num_words = 32;
+        break;
+      default:
+        num_words = ZeroExtend32(cw.parameter_word_count.GetValue());
+        break;
+    }
+
+    // truncated capture?
+    if (num_words > (word_count - pos))
+      break;
+
+    const u16* data = reinterpret_cast<const u16*>(&words[pos]);
+    pos += num_words;
+
+    s_data_in_fifo.Clear();
+    s_status.data_output_depth = cw.data_output_depth;
+    s_status.data_output_signed = cw.data_output_signed;
+    s_status.data_output_bit15 = cw.data_output_bit15;
+
+    switch (cw.command)
+    {
+      case Command::SetIqTab:
+      {
+        s_data_in_fifo.PushRange(data, num_words * 2);
+        s_remaining_halfwords = num_words * 2;
+        HandleSetQuantTableCommand();
+      }
+      break;
+
+      case Command::SetScale:
+      {
+        s_data_in_fifo.PushRange(data, num_words * 2);
+        s_remaining_halfwords = num_words * 2;
+        HandleSetScaleCommand();
+      }
+      break;
+
+      case Command::DecodeMacroblock:
+      {
+        // Same as HandleDecodeMacroblockCommand(), but the output is thrown away instead of being copied out.
+        const u32 num_halfwords = num_words * 2;
+        u32 halfwords_pushed = 0;
+        s_remaining_halfwords = num_halfwords;
+        ResetDecoder();
+
+        while (s_remaining_halfwords > 0)
+        {
+          const u32 count = std::min(s_data_in_fifo.GetSpace(), num_halfwords - halfwords_pushed);
+          s_data_in_fifo.PushRange(&data[halfwords_pushed], count);
+          halfwords_pushed += count;
+
+          if (s_status.data_output_depth <= DataOutputDepth_8Bit)
+          {
+            if (!rl_decode_block(s_blocks[0].data(), s_iq_y.data()))
+              continue;
+
+            IDCT(s_blocks[0].data());
+            ConvertMacroblock(s_status.data_output_depth, s_status.data_output_signed);
+            blocks_decoded++;
+          }
+          else
+          {
+            for (; s_current_block < NUM_BLOCKS; s_current_block++)
+            {
+              if (!rl_decode_block(s_blocks[s_current_block].data(),
+                                   (s_current_block >= 2) ? s_iq_y.data() : s_iq_uv.data()))
+              {
+                break;
+              }
+
+              IDCT(s_blocks[s_current_block].data());
+            }
+            if (s_current_block < NUM_BLOCKS)
+              continue;
+
+            ConvertMacroblock(s_status.data_output_depth, s_status.data_output_signed);
+            blocks_decoded += 4;
+          }
+
+          ResetDecoder();
+        }
+      }
+      break;
+
+      default:
+        break;
+    }
+  }
+
+  s_data_in_fifo.Clear();
+  ResetDecoder();
+  return blocks_decoded;
+}
+
+bool MDEC::VerifyKernels()
+{
+  // Fixed seed, so any failure is reproducible.
+  std::mt19937 rng(0x4D444543);
+  const auto random_s16 = [&rng](s32 min, s32 max) {
+    return static_cast<s16>(std::uniform_int_distribution<s32>(min, max)(rng));
+  };
+
+  static constexpr u32 NUM_SCALE_TABLES = 64;
+  static constexpr u32 BLOCKS_PER_SCALE_TABLE = 256;
+  u32 failures = 0;
+
+  // IDCT, with coefficients over the full range rl_decode_block() can produce. The first two scale tables and blocks
+  // are the largest magnitudes possible, since those are the most likely to overflow.
+  for (u32 table = 0; table < NUM_SCALE_TABLES; table++)
+  {
+    for (u32 i = 0; i < 64; i++)
+      s_scale_table[i] = (table == 0) ? s16(-32768) : ((table == 1) ? s16(32767) : random_s16(-32768, 32767));
+
+    for (u32 block = 0; block < BLOCKS_PER_SCALE_TABLE; block++)
+    {
+      std::array<s16, 64> expected, actual;
+      for (u32 i = 0; i < 64; i++)
+        expected[i] = (block == 0) ? s16(0x3FF) : ((block == 1) ? s16(-0x400) : random_s16(-0x400, 0x3FF));
+
+      actual = expected;
+      IDCT_New_Reference(expected.data());
+      IDCT_New(actual.data());
+      if (expected != actual)
+      {
+        Log_ErrorPrintf("IDCT mismatch with scale table %u block %u", table, block);
+        failures++;
+      }
+    }
+  }
+
+  // Colour conversion, with inputs over the range the IDCT outputs.
+  static constexpr u32 NUM_COLOR_MACROBLOCKS = 16384;
+  std::array<u32, 256> expected_rgb;
+  for (u32 mb = 0; mb < NUM_COLOR_MACROBLOCKS; mb++)
+  {
+    std::array<s16, 64> Crblk, Cbblk, Yblk;
+    for (u32 i = 0; i < 64; i++)
+    {
+      Crblk[i] = random_s16(-128, 127);
+      Cbblk[i] = random_s16(-128, 127);
+      Yblk[i] = random_s16(-128, 127);
+    }
+
+    const bool output_signed = ((mb & 1) != 0);
+    const u32 xx = (mb & 2) ? 8 : 0;
+    const u32 yy = (mb & 4) ? 8 : 0;
+    yuv_to_rgb_Reference(xx, yy, Crblk, Cbblk, Yblk, output_signed);
+    expected_rgb = s_block_rgb;
+    yuv_to_rgb(xx, yy, Crblk, Cbblk, Yblk, output_signed);
+    if (expected_rgb != s_block_rgb)
+    {
+      Log_ErrorPrintf("YUV to RGB mismatch in macroblock %u", mb);
+      failures++;
+    }
+
+    // Monochrome doesn't clamp its input beforehand, so use the whole 16-bit range.
+    for (u32 i = 0; i < 64; i++)
+      Yblk[i] = random_s16(-32768, 32767);
+
+    y_to_mono_Reference(Yblk);
+    expected_rgb = s_block_rgb;
+    y_to_mono(Yblk);
+    if (expected_rgb != s_block_rgb)
+    {
+      Log_ErrorPrintf("Y to mono mismatch in macroblock %u", mb);
+      failures++;
+    }
+  }
+
+  return (failures == 0);
+}
+
 void MDEC::DrawDebugStateWindow()
 {
   const float framebuffer_scale = Host::GetOSDScale();
@@ -13,6 +13,9 @@ void Shutdown();
 void Reset();
 bool DoState(StateWrapper& sw);
 
+/// Moves the IDCT and colour conversion of each macroblock to a worker thread.
+void SetUseThread(bool enabled);
+
 // I/O
 u32 ReadRegister(u32 offset);
 void WriteRegister(u32 offset, u32 value);
@@ -22,4 +25,16 @@ void DMAWrite(const u32* words, u32 word_count);
 
 void DrawDebugStateWindow();
 
+// Benchmarking
+bool StartCapture(const char* path);
+void StopCapture();
+
+/// Runs a capture through the decoder without any timing or output, returning the number of blocks decoded.
+/// Clobbers the MDEC state, so must not be used while the system is running.
+u32 DecodeCapture(const u32* words, u32 word_count);
+
+/// Checks the vectorized IDCT and colour conversion against the scalar reference, returning false on any mismatch.
+/// Clobbers the MDEC state, so must not be used while the system is running.
+bool VerifyKernels();
+
 } // namespace MDEC
@@ -64,6 +64,9 @@ struct Settings
   bool cpu_recompiler_memory_exceptions = false;
   bool cpu_recompiler_block_linking = true;
   bool cpu_recompiler_icache = false;
+  bool cpu_recompiler_block_cache = false;
+  bool cpu_recompiler_async_compile = false;
+  bool cpu_recompiler_traces = false;
   CPUFastmemMode cpu_fastmem_mode = DEFAULT_CPU_FASTMEM_MODE;
 
   float emulation_speed = 1.0f;
@@ -97,6 +100,7 @@ struct Settings
   u32 gpu_resolution_scale = 1;
   u32 gpu_multisamples = 1;
   bool gpu_use_thread = true;
+  u32 gpu_sw_threads = 0;
   bool gpu_use_software_renderer_for_readbacks = false;
   bool gpu_threaded_presentation = true;
   bool gpu_use_debug_device = false;
@@ -170,6 +174,7 @@ struct Settings
   bool audio_dump_on_boot = false;
 
   bool use_old_mdec_routines = false;
+  bool mdec_use_thread = false;
   bool pcdrv_enable = false;
 
   // timing hacks section
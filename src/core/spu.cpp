@@ -199,6 +199,17 @@ struct ADPCMBlock
   u8 GetNibble(u32 index) const { return (data[index / 2] >> ((index % 2) * 4)) & 0x0F; }
 };
 
+// ADPCM block with the nibbles expanded and shifted, but without the filter applied. The filter depends on the
+// previous samples of the voice, so only this part can be shared between voices and repeated loops.
+struct DecodedADPCMBlock
+{
+  u16 address; // in 8-byte units, blocks can start on any 8-byte boundary
+  bool valid;
+  u8 filter;
+  ADPCMFlags flags;
+  std::array<s16, NUM_SAMPLES_PER_ADPCM_BLOCK> samples;
+};
+
 struct VolumeEnvelope
 {
   s32 counter;
@@ -255,7 +266,7 @@ struct Voice
   void KeyOff();
   void ForceOff();
 
-  void DecodeBlock(const ADPCMBlock& block);
+  void DecodeBlock(const DecodedADPCMBlock& block);
   s32 Interpolate() const;
 
   // Switches to the specified phase, filling in target.
@@ -321,6 +332,9 @@ static void WriteToCaptureBuffer(u32 index, s16 value);
 static void IncrementCaptureBufferPosition();
 
 static void ReadADPCMBlock(u16 address, ADPCMBlock* block);
+static const DecodedADPCMBlock& GetDecodedADPCMBlock(u16 address);
+static void InvalidateDecodedADPCMBlocks(u32 ram_address);
+static void InvalidateAllDecodedADPCMBlocks();
 static std::tuple<s32, s32> SampleVoice(u32 voice_index);
 
 static void UpdateNoise();
@@ -397,6 +411,10 @@ static InlineFIFOQueue<u16, FIFO_SIZE_IN_HALFWORDS> s_transfer_fifo;
 
 static std::array<u8, RAM_SIZE> s_ram{};
 
+// Direct-mapped by block address. Entries are invalidated whenever the RAM they were decoded from is written.
+static constexpr u32 ADPCM_CACHE_SIZE = 4096;
+static std::array<DecodedADPCMBlock, ADPCM_CACHE_SIZE> s_adpcm_cache{};
+
 #ifdef SPU_DUMP_ALL_VOICES
 // +1 for reverb output
 static std::array<std::unique_ptr<Common::WAVWriter>, NUM_VOICES + 1> s_voice_dump_writers;
@@ -517,6 +535,7 @@ void SPU::Reset()
   s_transfer_fifo.Clear();
   s_transfer_event->Deactivate();
   s_ram.fill(0);
+  InvalidateAllDecodedADPCMBlocks();
   UpdateEventInterval();
 }
 
@@ -583,6 +602,7 @@ bool SPU::DoState(StateWrapper& sw)
 
   if (sw.IsReading())
   {
+    InvalidateAllDecodedADPCMBlocks();
     UpdateEventInterval();
     UpdateTransferEvent();
   }
@@ -1181,6 +1201,7 @@ void SPU::WriteToCaptureBuffer(u32 index, s16 value)
   const u32 ram_address = (index * CAPTURE_BUFFER_SIZE_PER_CHANNEL) | ZeroExtend16(s_capture_buffer_position);
   // Log_DebugPrintf("write to capture buffer %u (0x%08X) <- 0x%04X", index, ram_address, u16(value));
   std::memcpy(&s_ram[ram_address], &value, sizeof(value));
+  InvalidateDecodedADPCMBlocks(ram_address);
   if (IsRAMIRQTriggerable() && CheckRAMIRQ(ram_address))
   {
     Log_DebugPrintf("Trigger IRQ @ %08X %04X from capture buffer", ram_address, ram_address / 8);
@@ -1219,6 +1240,7 @@ ALWAYS_INLINE_RELEASE void SPU::ExecuteFIFOWriteToRAM(TickCount& ticks)
   {
     u16 value = s_transfer_fifo.Pop();
     std::memcpy(&s_ram[s_transfer_address], &value, sizeof(u16));
+    InvalidateDecodedADPCMBlocks(s_transfer_address);
     s_transfer_address = (s_transfer_address + sizeof(u16)) & RAM_MASK;
     ticks -= TRANSFER_TICKS_PER_HALFWORD;
 
@@ -1294,6 +1316,7 @@ void SPU::ManualTransferWrite(u16 value)
   }
 
   std::memcpy(&s_ram[s_transfer_address], &value, sizeof(u16));
+  InvalidateDecodedADPCMBlocks(s_transfer_address);
   s_transfer_address = (s_transfer_address + sizeof(u16)) & RAM_MASK;
 
   if (IsRAMIRQTriggerable() && CheckRAMIRQ(s_transfer_address))
@@ -1527,6 +1550,8 @@ const std::array<u8, SPU::RAM_SIZE>& SPU::GetRAM()
 
 std::array<u8, SPU::RAM_SIZE>& SPU::GetWritableRAM()
 {
+  // We don't know what the caller is going to write.
+  InvalidateAllDecodedADPCMBlocks();
   return s_ram;
 }
 
@@ -1773,7 +1798,7 @@ void SPU::Voice::TickADSR()
   }
 }
 
-void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
+void SPU::Voice::DecodeBlock(const DecodedADPCMBlock& block)
 {
   static constexpr std::array<s32, 5> filter_table_pos = {{0, 60, 115, 98, 122}};
   static constexpr std::array<s32, 5> filter_table_neg = {{0, 0, -52, -55, -60}};
@@ -1782,19 +1807,28 @@ void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
   current_block_samples[2] = current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + NUM_SAMPLES_PER_ADPCM_BLOCK - 1];
   current_block_samples[1] = current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + NUM_SAMPLES_PER_ADPCM_BLOCK - 2];
   current_block_samples[0] = current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK + NUM_SAMPLES_PER_ADPCM_BLOCK - 3];
+  current_block_flags.bits = block.flags.bits;
+
+  // filter 0 doesn't use the previous samples, and the shifted nibbles are already in range
+  if (block.filter == 0)
+  {
+    std::copy(block.samples.begin(), block.samples.end(),
+              &current_block_samples[NUM_SAMPLES_FROM_LAST_ADPCM_BLOCK]);
+    adpcm_last_samples[0] = block.samples[NUM_SAMPLES_PER_ADPCM_BLOCK - 1];
+    adpcm_last_samples[1] = block.samples[NUM_SAMPLES_PER_ADPCM_BLOCK - 2];
+    return;
+  }
 
   // pre-lookup
-  const u8 shift = block.GetShift();
-  const u8 filter_index = block.GetFilter();
-  const s32 filter_pos = filter_table_pos[filter_index];
-  const s32 filter_neg = filter_table_neg[filter_index];
+  const s32 filter_pos = filter_table_pos[block.filter];
+  const s32 filter_neg = filter_table_neg[block.filter];
   s16 last_samples[2] = {adpcm_last_samples[0], adpcm_last_samples[1]};
 
   // samples
   for (u32 i = 0; i < NUM_SAMPLES_PER_ADPCM_BLOCK; i++)
   {
-    // extend 4-bit to 16-bit, apply shift from header and mix in previous samples
-    s32 sample = s32(static_cast<s16>(ZeroExtend16(block.GetNibble(i)) << 12) >> shift);
+    // mix in previous samples
+    s32 sample = s32(block.samples[i]);
     sample += (last_samples[0] * filter_pos) >> 6;
     sample += (last_samples[1] * filter_neg) >> 6;
 
@@ -1803,7 +1837,6 @@ void SPU::Voice::DecodeBlock(const ADPCMBlock& block)
   }
 
   std::copy(last_samples, last_samples + countof(last_samples), adpcm_last_samples.begin());
-  current_block_flags.bits = block.flags.bits;
 }
 
 s32 SPU::Voice::Interpolate() const
@@ -1912,6 +1945,55 @@ void SPU::ReadADPCMBlock(u16 address, ADPCMBlock* block)
   }
 }
 
+const SPU::DecodedADPCMBlock& SPU::GetDecodedADPCMBlock(u16 address)
+{
+  DecodedADPCMBlock& entry = s_adpcm_cache[address % ADPCM_CACHE_SIZE];
+  if (entry.valid && entry.address == address)
+  {
+    // still have to raise the IRQ as if the block was read
+    const u32 ram_address = (ZeroExtend32(address) * 8) & RAM_MASK;
+    if (IsRAMIRQTriggerable() && (CheckRAMIRQ(ram_address) || CheckRAMIRQ((ram_address + 8) & RAM_MASK)))
+    {
+      Log_DebugPrintf("Trigger IRQ @ %08X %04X from ADPCM reader", ram_address, ram_address / 8);
+      TriggerRAMIRQ();
+    }
+
+    return entry;
+  }
+
+  ADPCMBlock block;
+  ReadADPCMBlock(address, &block);
+
+  // extend 4-bit to 16-bit and apply shift from header
+  const u8 shift = block.GetShift();
+  for (u32 i = 0; i < NUM_SAMPLES_PER_ADPCM_BLOCK; i++)
+    entry.samples[i] = static_cast<s16>(static_cast<s16>(ZeroExtend16(block.GetNibble(i)) << 12) >> shift);
+
+  entry.address = address;
+  entry.valid = true;
+  entry.filter = block.GetFilter();
+  entry.flags.bits = block.flags.bits;
+  return entry;
+}
+
+ALWAYS_INLINE_RELEASE void SPU::InvalidateDecodedADPCMBlocks(u32 ram_address)
+{
+  // a block covers two 8-byte units, so it could have started in the previous one
+  const u16 address = Truncate16(ram_address / 8);
+  for (const u16 block_address : {address, static_cast<u16>(address - 1)})
+  {
+    DecodedADPCMBlock& entry = s_adpcm_cache[block_address % ADPCM_CACHE_SIZE];
+    if (entry.address == block_address)
+      entry.valid = false;
+  }
+}
+
+void SPU::InvalidateAllDecodedADPCMBlocks()
+{
+  for (DecodedADPCMBlock& entry : s_adpcm_cache)
+    entry.valid = false;
+}
+
 ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
 {
   Voice& voice = s_voices[voice_index];
@@ -1932,9 +2014,7 @@ ALWAYS_INLINE_RELEASE std::tuple<s32, s32> SPU::SampleVoice(u32 voice_index)
 
   if (!voice.has_samples)
   {
-    ADPCMBlock block;
-    ReadADPCMBlock(voice.current_address, &block);
-    voice.DecodeBlock(block);
+    voice.DecodeBlock(GetDecodedADPCMBlock(voice.current_address));
     voice.has_samples = true;
 
     if (voice.current_block_flags.loop_start && !voice.ignore_loop_address)
@@ -2080,6 +2160,7 @@ void SPU::ReverbWrite(u32 address, s16 data)
   // TODO: This should check interrupts.
   const u32 real_address = ReverbMemoryAddress(address << 2);
   std::memcpy(&s_ram[real_address], &data, sizeof(data));
+  InvalidateDecodedADPCMBlocks(real_address);
 }
 
 // Zeroes optimized out; middle removed too(it's 16384)
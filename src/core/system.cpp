@@ -47,13 +47,16 @@
 #include "util/iso_reader.h"
 #include "util/state_wrapper.h"
 #include "xxhash.h"
+#include <atomic>
 #include <cctype>
 #include <cinttypes>
 #include <cmath>
+#include <condition_variable>
 #include <cstdio>
 #include <deque>
 #include <fstream>
 #include <limits>
+#include <mutex>
 #include <thread>
 Log_SetChannel(System);
 
@@ -80,12 +83,46 @@ struct MemorySaveState
   std::unique_ptr<GrowableMemoryByteStream> state_stream;
 };
 
+/// Rewind states are stored as a periodic full keyframe, with the states in between only holding the pages which
+/// differ from the keyframe. Most of RAM and SPU RAM do not change between saves, so this is far smaller. VRAM is only
+/// part of the delta with the software renderer; the hardware renderers keep a full copy in vram_texture per slot.
+struct RewindSaveState
+{
+  /// State data, which is compressed on the rewind compression thread after it has been captured.
+  struct Data
+  {
+    std::mutex mutex;
+    std::vector<u8> data;
+    std::atomic<u32> stored_size{0};
+    u32 uncompressed_size = 0;
+    bool compressed = false;
+  };
+
+  std::unique_ptr<GPUTexture> vram_texture;
+
+  /// Full state which this state is relative to. For keyframes, this is the state itself.
+  std::shared_ptr<Data> keyframe;
+
+  /// Indices of pages which differ from the keyframe, and their contents.
+  std::vector<u32> delta_pages;
+  std::shared_ptr<Data> delta_data;
+
+  u32 state_size = 0;
+  bool is_keyframe = false;
+};
+
 namespace System {
 static std::optional<ExtendedSaveStateInfo> InternalGetExtendedSaveStateInfo(ByteStream* stream);
 static bool InternalSaveState(ByteStream* state, u32 screenshot_size = 256,
                               u32 compression_method = SAVE_STATE_HEADER::COMPRESSION_TYPE_NONE);
 static bool SaveMemoryState(MemorySaveState* mss);
 static bool LoadMemoryState(const MemorySaveState& mss);
+static u64 GetRewindStateMemoryUsage(const RewindSaveState& rss);
+static std::shared_ptr<RewindSaveState::Data> CreateRewindStateData(const u8* data, u32 size);
+static bool ReadRewindStateData(RewindSaveState::Data& data, u8* dest);
+static void StartRewindCompressionThread();
+static void StopRewindCompressionThread();
+static void RewindCompressionThreadEntryPoint();
 
 static bool LoadEXE(const char* filename);
 
@@ -202,7 +239,25 @@ static std::unique_ptr<ByteStream> m_undo_load_state;
 
 static bool s_memory_saves_enabled = false;
 
-static std::deque<MemorySaveState> s_rewind_states;
+static constexpr u32 REWIND_PAGE_SIZE = 4096;
+static constexpr u32 REWIND_KEYFRAME_INTERVAL = 30;
+static constexpr int REWIND_COMPRESSION_LEVEL = 1;
+
+static std::deque<RewindSaveState> s_rewind_states;
+static std::unique_ptr<GrowableMemoryByteStream> s_rewind_state_stream;
+static std::vector<u8> s_rewind_delta_buffer;
+static u32 s_rewind_saves_since_keyframe = 0;
+static std::atomic<u64> s_rewind_average_state_size{0};
+
+// Uncompressed copy of the most recent keyframe, which new states are compared against.
+static std::shared_ptr<RewindSaveState::Data> s_rewind_last_keyframe;
+static std::vector<u8> s_rewind_last_keyframe_data;
+
+static Threading::Thread s_rewind_compression_thread;
+static std::mutex s_rewind_compression_mutex;
+static std::condition_variable s_rewind_compression_cv;
+static std::deque<std::shared_ptr<RewindSaveState::Data>> s_rewind_compression_queue;
+static bool s_rewind_compression_thread_shutdown = false;
 static s32 s_rewind_load_frequency = -1;
 static s32 s_rewind_load_counter = -1;
 static s32 s_rewind_save_frequency = -1;
@@ -3150,6 +3205,7 @@ void System::UpdateRunningGame(const char* path, CDImage* image, bool booting)
   }
 
   g_texture_replacements.SetGameID(s_running_game_serial);
+  CPU::CodeCache::SetBlockCacheSerial(s_running_game_serial);
 
 #ifdef WITH_CHEEVOS
   if (booting)
@@ -3367,12 +3423,15 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     if (g_settings.cpu_execution_mode == CPUExecutionMode::Recompiler &&
         (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions ||
          g_settings.cpu_recompiler_block_linking != old_settings.cpu_recompiler_block_linking ||
-         g_settings.cpu_recompiler_icache != old_settings.cpu_recompiler_icache))
+         g_settings.cpu_recompiler_icache != old_settings.cpu_recompiler_icache ||
+         g_settings.cpu_recompiler_async_compile != old_settings.cpu_recompiler_async_compile ||
+         g_settings.cpu_recompiler_traces != old_settings.cpu_recompiler_traces))
     {
       Host::AddOSDMessage(TRANSLATE_STR("OSDMessage", "Recompiler options changed, flushing all blocks."), 5.0f);
 
-      // changing memory exceptions can re-enable fastmem
-      if (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions)
+      // changing memory exceptions can re-enable fastmem, background compilation splits the code buffer
+      if (g_settings.cpu_recompiler_memory_exceptions != old_settings.cpu_recompiler_memory_exceptions ||
+          g_settings.cpu_recompiler_async_compile != old_settings.cpu_recompiler_async_compile)
         CPU::CodeCache::Reinitialize();
       else
         CPU::CodeCache::Flush();
@@ -3387,6 +3446,7 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
         g_settings.gpu_multisamples != old_settings.gpu_multisamples ||
         g_settings.gpu_per_sample_shading != old_settings.gpu_per_sample_shading ||
         g_settings.gpu_use_thread != old_settings.gpu_use_thread ||
+        g_settings.gpu_sw_threads != old_settings.gpu_sw_threads ||
         g_settings.gpu_use_software_renderer_for_readbacks != old_settings.gpu_use_software_renderer_for_readbacks ||
         g_settings.gpu_fifo_size != old_settings.gpu_fifo_size ||
         g_settings.gpu_max_run_ahead != old_settings.gpu_max_run_ahead ||
@@ -3449,6 +3509,9 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
     if (g_settings.cdrom_readahead_sectors != old_settings.cdrom_readahead_sectors)
       CDROM::SetReadaheadSectors(g_settings.cdrom_readahead_sectors);
 
+    if (g_settings.mdec_use_thread != old_settings.mdec_use_thread)
+      MDEC::SetUseThread(g_settings.mdec_use_thread);
+
     if (g_settings.memory_card_types != old_settings.memory_card_types ||
         g_settings.memory_card_paths != old_settings.memory_card_paths ||
         (g_settings.memory_card_use_playlist_title != old_settings.memory_card_use_playlist_title &&
@@ -3529,14 +3592,39 @@ void System::CheckForSettingsChanges(const Settings& old_settings)
 
 void System::CalculateRewindMemoryUsage(u32 num_saves, u64* ram_usage, u64* vram_usage)
 {
-  *ram_usage = MAX_SAVE_STATE_SIZE * static_cast<u64>(num_saves);
+  const u64 average_state_size = s_rewind_average_state_size.load(std::memory_order_relaxed);
+  if (average_state_size > 0)
+  {
+    // Extrapolate from the states we actually have.
+    *ram_usage = average_state_size * num_saves;
+  }
+  else
+  {
+    // Deltas larger than half of a full state are stored as keyframes instead, so this is the worst case.
+    const u64 num_keyframes = (num_saves + REWIND_KEYFRAME_INTERVAL - 1) / REWIND_KEYFRAME_INTERVAL;
+    *ram_usage = (MAX_SAVE_STATE_SIZE * num_keyframes) + ((MAX_SAVE_STATE_SIZE / 2) * (num_saves - num_keyframes));
+  }
+
+  // The software renderer saves VRAM in the state itself, so it's already counted above.
+  if (g_settings.IsUsingSoftwareRenderer())
+  {
+    *vram_usage = 0;
+    return;
+  }
+
   *vram_usage = (VRAM_WIDTH * VRAM_HEIGHT * 4) * static_cast<u64>(std::max(g_settings.gpu_resolution_scale, 1u)) *
                 static_cast<u64>(g_settings.gpu_multisamples) * static_cast<u64>(num_saves);
 }
 
 void System::ClearMemorySaveStates()
 {
+  StopRewindCompressionThread();
   s_rewind_states.clear();
+  s_rewind_last_keyframe.reset();
+  s_rewind_last_keyframe_data = {};
+  s_rewind_state_stream.reset();
+  s_rewind_saves_since_keyframe = 0;
+  s_rewind_average_state_size.store(0, std::memory_order_relaxed);
   s_runahead_states.clear();
 }
 
@@ -3608,6 +3696,112 @@ bool System::SaveMemoryState(MemorySaveState* mss)
   return true;
 }
 
+u64 System::GetRewindStateMemoryUsage(const RewindSaveState& rss)
+{
+  if (rss.is_keyframe)
+    return rss.keyframe->stored_size.load(std::memory_order_relaxed);
+
+  return (rss.delta_pages.size() * sizeof(u32)) + rss.delta_data->stored_size.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<RewindSaveState::Data> System::CreateRewindStateData(const u8* data, u32 size)
+{
+  std::shared_ptr<RewindSaveState::Data> ret = std::make_shared<RewindSaveState::Data>();
+  ret->data.assign(data, data + size);
+  ret->uncompressed_size = size;
+  ret->stored_size.store(size, std::memory_order_relaxed);
+
+  // Hand it off to the worker thread to compress.
+  std::unique_lock lock(s_rewind_compression_mutex);
+  s_rewind_compression_queue.push_back(ret);
+  s_rewind_compression_cv.notify_one();
+  return ret;
+}
+
+bool System::ReadRewindStateData(RewindSaveState::Data& data, u8* dest)
+{
+  std::unique_lock lock(data.mutex);
+  if (!data.compressed)
+  {
+    std::memcpy(dest, data.data.data(), data.uncompressed_size);
+    return true;
+  }
+
+  ReadOnlyMemoryByteStream src_stream(data.data.data(), static_cast<u32>(data.data.size()));
+  std::unique_ptr<ByteStream> stream =
+    ByteStream::CreateZstdDecompressStream(&src_stream, static_cast<u32>(data.data.size()));
+  return stream->Read2(dest, data.uncompressed_size);
+}
+
+void System::StartRewindCompressionThread()
+{
+  s_rewind_compression_thread_shutdown = false;
+  s_rewind_compression_thread.Start(&System::RewindCompressionThreadEntryPoint);
+}
+
+void System::StopRewindCompressionThread()
+{
+  if (!s_rewind_compression_thread.Joinable())
+    return;
+
+  {
+    std::unique_lock lock(s_rewind_compression_mutex);
+    s_rewind_compression_queue.clear();
+    s_rewind_compression_thread_shutdown = true;
+    s_rewind_compression_cv.notify_one();
+  }
+
+  s_rewind_compression_thread.Join();
+}
+
+void System::RewindCompressionThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("Rewind Compression");
+
+  GrowableMemoryByteStream compressed_stream(nullptr, MAX_SAVE_STATE_SIZE / 4);
+  std::unique_lock lock(s_rewind_compression_mutex);
+  for (;;)
+  {
+    s_rewind_compression_cv.wait(
+      lock, []() { return (s_rewind_compression_thread_shutdown || !s_rewind_compression_queue.empty()); });
+    if (s_rewind_compression_thread_shutdown)
+      break;
+
+    std::shared_ptr<RewindSaveState::Data> data = std::move(s_rewind_compression_queue.front());
+    s_rewind_compression_queue.pop_front();
+
+    // Don't bother if the state has already been dropped.
+    if (data.use_count() == 1)
+      continue;
+
+    lock.unlock();
+
+    // The uncompressed data is never modified after it's queued, so it can be read without holding its lock.
+    compressed_stream.SeekAbsolute(0);
+    std::unique_ptr<ByteStream> stream =
+      ByteStream::CreateZstdCompressStream(&compressed_stream, REWIND_COMPRESSION_LEVEL);
+    if (stream->Write2(data->data.data(), data->uncompressed_size) && stream->Commit())
+    {
+      stream.reset();
+
+      const u32 compressed_size = static_cast<u32>(compressed_stream.GetPosition());
+      std::vector<u8> compressed_data(compressed_stream.GetMemoryPointer(),
+                                      compressed_stream.GetMemoryPointer() + compressed_size);
+
+      std::unique_lock data_lock(data->mutex);
+      data->data = std::move(compressed_data);
+      data->compressed = true;
+      data->stored_size.store(compressed_size, std::memory_order_relaxed);
+    }
+    else
+    {
+      Log_ErrorPrint("Failed to compress rewind state.");
+    }
+
+    lock.lock();
+  }
+}
+
 bool System::SaveRewindState()
 {
 #ifdef PROFILE_MEMORY_SAVE_STATES
@@ -3616,21 +3810,94 @@ bool System::SaveRewindState()
 
   // try to reuse the frontmost slot
   const u32 save_slots = g_settings.rewind_save_slots;
-  MemorySaveState mss;
+  RewindSaveState rss;
   while (s_rewind_states.size() >= save_slots)
   {
-    mss = std::move(s_rewind_states.front());
+    rss = std::move(s_rewind_states.front());
     s_rewind_states.pop_front();
   }
 
-  if (!SaveMemoryState(&mss))
+  if (!s_rewind_state_stream)
+    s_rewind_state_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+  else
+    s_rewind_state_stream->SeekAbsolute(0);
+
+  GPUTexture* host_texture = rss.vram_texture.release();
+  StateWrapper sw(s_rewind_state_stream.get(), StateWrapper::Mode::Write, SAVE_STATE_VERSION);
+  if (!DoState(sw, &host_texture, false, true))
+  {
+    Log_ErrorPrint("Failed to create rewind state.");
+    delete host_texture;
     return false;
+  }
+
+  if (!s_rewind_compression_thread.Joinable())
+    StartRewindCompressionThread();
+
+  rss.vram_texture.reset(host_texture);
+  rss.state_size = static_cast<u32>(s_rewind_state_stream->GetPosition());
+  rss.keyframe.reset();
+  rss.delta_pages.clear();
+  rss.delta_data.reset();
+  rss.is_keyframe = false;
 
-  s_rewind_states.push_back(std::move(mss));
+  // If we rewound past the last keyframe, we no longer have an uncompressed copy to compare against.
+  const u8* state_data = s_rewind_state_stream->GetMemoryPointer();
+  bool is_keyframe =
+    (!s_rewind_last_keyframe || s_rewind_last_keyframe_data.size() != rss.state_size ||
+     s_rewind_saves_since_keyframe >= REWIND_KEYFRAME_INTERVAL ||
+     (!s_rewind_states.empty() && s_rewind_states.back().keyframe != s_rewind_last_keyframe));
+  if (!is_keyframe)
+  {
+    // Store only the pages which differ from the keyframe.
+    std::vector<u8>& delta_data = s_rewind_delta_buffer;
+    delta_data.clear();
+
+    const u8* keyframe_data = s_rewind_last_keyframe_data.data();
+    for (u32 offset = 0, page = 0; offset < rss.state_size; offset += REWIND_PAGE_SIZE, page++)
+    {
+      const u32 size = std::min(rss.state_size - offset, REWIND_PAGE_SIZE);
+      if (std::memcmp(keyframe_data + offset, state_data + offset, size) == 0)
+        continue;
+
+      rss.delta_pages.push_back(page);
+      delta_data.insert(delta_data.end(), state_data + offset, state_data + offset + size);
+    }
+
+    // If most of the state changed, it's not worth keeping the delta.
+    is_keyframe = (delta_data.size() > (rss.state_size / 2));
+    if (!is_keyframe)
+    {
+      rss.keyframe = s_rewind_last_keyframe;
+      rss.delta_data = CreateRewindStateData(delta_data.data(), static_cast<u32>(delta_data.size()));
+      s_rewind_saves_since_keyframe++;
+    }
+  }
+
+  if (is_keyframe)
+  {
+    rss.delta_pages.clear();
+    rss.keyframe = CreateRewindStateData(state_data, rss.state_size);
+    rss.is_keyframe = true;
+    s_rewind_last_keyframe = rss.keyframe;
+    s_rewind_last_keyframe_data.assign(state_data, state_data + rss.state_size);
+    s_rewind_saves_since_keyframe = 0;
+  }
+
+  s_rewind_states.push_back(std::move(rss));
+
+  // Keyframes which have been dropped but are still referenced by deltas are counted once.
+  u64 total_size = s_rewind_states.front().is_keyframe ?
+                     0 :
+                     s_rewind_states.front().keyframe->stored_size.load(std::memory_order_relaxed);
+  for (const RewindSaveState& it : s_rewind_states)
+    total_size += GetRewindStateMemoryUsage(it);
+  s_rewind_average_state_size.store(total_size / s_rewind_states.size(), std::memory_order_relaxed);
 
 #ifdef PROFILE_MEMORY_SAVE_STATES
-  Log_DevPrintf("Saved rewind state (%" PRIu64 " bytes, took %.4f ms)", s_rewind_states.back().state_stream->GetSize(),
-                save_timer.GetTimeMilliseconds());
+  Log_DevPrintf("Saved rewind %s (%u bytes, %" PRIu64 " bytes stored, took %.4f ms)",
+                is_keyframe ? "keyframe" : "delta", s_rewind_states.back().state_size,
+                GetRewindStateMemoryUsage(s_rewind_states.back()), save_timer.GetTimeMilliseconds());
 #endif
 
   return true;
@@ -3651,8 +3918,40 @@ bool System::LoadRewindState(u32 skip_saves /*= 0*/, bool consume_state /*=true
   Common::Timer load_timer;
 #endif
 
-  if (!LoadMemoryState(s_rewind_states.back()))
+  // Rebuild the full state from the keyframe and changed pages.
+  const RewindSaveState& rss = s_rewind_states.back();
+  if (!s_rewind_state_stream)
+    s_rewind_state_stream = std::make_unique<GrowableMemoryByteStream>(nullptr, MAX_SAVE_STATE_SIZE);
+
+  s_rewind_state_stream->Resize(rss.state_size);
+  u8* state_data = s_rewind_state_stream->GetMemoryPointer();
+  bool result = ReadRewindStateData(*rss.keyframe, state_data);
+  if (result && !rss.is_keyframe)
+  {
+    std::vector<u8>& delta_data = s_rewind_delta_buffer;
+    delta_data.resize(rss.delta_data->uncompressed_size);
+    result = ReadRewindStateData(*rss.delta_data, delta_data.data());
+
+    const u8* delta_ptr = delta_data.data();
+    for (const u32 page : rss.delta_pages)
+    {
+      const u32 offset = page * REWIND_PAGE_SIZE;
+      const u32 size = std::min(rss.state_size - offset, REWIND_PAGE_SIZE);
+      std::memcpy(state_data + offset, delta_ptr, size);
+      delta_ptr += size;
+    }
+  }
+
+  s_rewind_state_stream->SeekAbsolute(0);
+
+  StateWrapper sw(s_rewind_state_stream.get(), StateWrapper::Mode::Read, SAVE_STATE_VERSION);
+  GPUTexture* host_texture = rss.vram_texture.get();
+  if (!result || !DoState(sw, &host_texture, true, true))
+  {
+    Host::ReportErrorAsync("Error", "Failed to load memory save state, resetting.");
+    InternalReset();
     return false;
+  }
 
   if (consume_state)
     s_rewind_states.pop_back();
@@ -8,12 +8,16 @@
 #include "cpu_core_private.h"
 #include "system.h"
 #include "util/state_wrapper.h"
+#include <array>
 Log_SetChannel(TimingEvents);
 
 namespace TimingEvents {
 
-static TimingEvent* s_active_events_head;
-static TimingEvent* s_active_events_tail;
+// Active events are kept in a contiguous array sorted by downcount, so the head is always the first element.
+// Equal downcounts keep the same relative order as the old linked list, so event dispatch order is unchanged.
+static constexpr u32 MAX_ACTIVE_EVENTS = 64;
+
+static std::array<TimingEvent*, MAX_ACTIVE_EVENTS> s_active_events;
 static TimingEvent* s_current_event = nullptr;
 static u32 s_active_event_count = 0;
 static u32 s_global_tick_counter = 0;
@@ -52,207 +56,123 @@ std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount perio
 
 void UpdateCPUDowncount()
 {
-  CPU::g_state.downcount = CPU::HasPendingInterrupt() ? 0 : s_active_events_head->GetDowncount();
+  CPU::g_state.downcount = CPU::HasPendingInterrupt() ? 0 : s_active_events[0]->GetDowncount();
 }
 
 TimingEvent** GetHeadEventPtr()
 {
-  return &s_active_events_head;
+  return &s_active_events[0];
+}
+
+/// Returns the first index in [first, last) with a downcount greater than (upper) or not less than (lower) downcount.
+template<bool upper>
+static u32 FindInsertPosition(u32 first, u32 last, TickCount downcount)
+{
+  while (first < last)
+  {
+    const u32 mid = first + (last - first) / 2;
+    const TickCount mid_downcount = s_active_events[mid]->m_downcount;
+    if (upper ? (mid_downcount <= downcount) : (mid_downcount < downcount))
+      first = mid + 1;
+    else
+      last = mid;
+  }
+
+  return first;
 }
 
 static void SortEvent(TimingEvent* event)
 {
   const TickCount event_downcount = event->m_downcount;
+  const u32 index = event->m_active_index;
 
-  if (event->prev && event->prev->m_downcount > event_downcount)
+  if (index > 0 && s_active_events[index - 1]->m_downcount > event_downcount)
   {
-    // move backwards
-    TimingEvent* current = event->prev;
-    while (current && current->m_downcount > event_downcount)
-      current = current->prev;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
-
-    // insert after current
-    if (current)
+    // move backwards, after any events with the same downcount
+    const u32 new_index = FindInsertPosition<true>(0, index, event_downcount);
+    for (u32 i = index; i > new_index; i--)
     {
-      event->next = current->next;
-      if (current->next)
-        current->next->prev = event;
-      else
-        s_active_events_tail = event;
-
-      event->prev = current;
-      current->next = event;
+      s_active_events[i] = s_active_events[i - 1];
+      s_active_events[i]->m_active_index = i;
     }
-    else
-    {
-      // insert at front
-      DebugAssert(s_active_events_head);
-      s_active_events_head->prev = event;
-      event->prev = nullptr;
-      event->next = s_active_events_head;
-      s_active_events_head = event;
+
+    s_active_events[new_index] = event;
+    event->m_active_index = new_index;
+    if (new_index == 0)
       UpdateCPUDowncount();
-    }
   }
-  else if (event->next && event_downcount > event->next->m_downcount)
+  else if ((index + 1) < s_active_event_count && event_downcount > s_active_events[index + 1]->m_downcount)
   {
-    // move forwards
-    TimingEvent* current = event->next;
-    while (current && event_downcount > current->m_downcount)
-      current = current->next;
-
-    // unlink
-    if (event->prev)
-      event->prev->next = event->next;
-    else
-      s_active_events_head = event->next;
-    if (event->next)
-      event->next->prev = event->prev;
-    else
-      s_active_events_tail = event->prev;
-
-    // insert before current
-    if (current)
-    {
-      event->next = current;
-      event->prev = current->prev;
-
-      if (current->prev)
-        current->prev->next = event;
-      else
-        s_active_events_head = event;
-
-      current->prev = event;
-    }
-    else
+    // move forwards, before any events with the same downcount
+    const u32 new_index = FindInsertPosition<false>(index + 1, s_active_event_count, event_downcount) - 1;
+    for (u32 i = index; i < new_index; i++)
     {
-      // insert at back
-      DebugAssert(s_active_events_tail);
-      s_active_events_tail->next = event;
-      event->next = nullptr;
-      event->prev = s_active_events_tail;
-      s_active_events_tail = event;
+      s_active_events[i] = s_active_events[i + 1];
+      s_active_events[i]->m_active_index = i;
     }
+
+    s_active_events[new_index] = event;
+    event->m_active_index = new_index;
   }
 }
 
 static void AddActiveEvent(TimingEvent* event)
 {
-  DebugAssert(!event->prev && !event->next);
-  s_active_event_count++;
+  Assert(s_active_event_count < MAX_ACTIVE_EVENTS);
 
-  TimingEvent* current = nullptr;
-  TimingEvent* next = s_active_events_head;
-  while (next && event->m_downcount > next->m_downcount)
+  const u32 new_index = FindInsertPosition<false>(0, s_active_event_count, event->m_downcount);
+  for (u32 i = s_active_event_count; i > new_index; i--)
   {
-    current = next;
-    next = next->next;
+    s_active_events[i] = s_active_events[i - 1];
+    s_active_events[i]->m_active_index = i;
   }
 
-  if (!next)
-  {
-    // new tail
-    event->prev = s_active_events_tail;
-    if (s_active_events_tail)
-    {
-      s_active_events_tail->next = event;
-      s_active_events_tail = event;
-    }
-    else
-    {
-      // first event
-      s_active_events_tail = event;
-      s_active_events_head = event;
-      UpdateCPUDowncount();
-    }
-  }
-  else if (!current)
-  {
-    // new head
-    event->next = s_active_events_head;
-    s_active_events_head->prev = event;
-    s_active_events_head = event;
+  s_active_events[new_index] = event;
+  event->m_active_index = new_index;
+  s_active_event_count++;
+
+  if (new_index == 0)
     UpdateCPUDowncount();
-  }
-  else
-  {
-    // inbetween current < event > next
-    event->prev = current;
-    event->next = next;
-    current->next = event;
-    next->prev = event;
-  }
 }
 
 static void RemoveActiveEvent(TimingEvent* event)
 {
   DebugAssert(s_active_event_count > 0);
+  DebugAssert(s_active_events[event->m_active_index] == event);
 
-  if (event->next)
-  {
-    event->next->prev = event->prev;
-  }
-  else
-  {
-    s_active_events_tail = event->prev;
-  }
-
-  if (event->prev)
-  {
-    event->prev->next = event->next;
-  }
-  else
+  const u32 index = event->m_active_index;
+  s_active_event_count--;
+  for (u32 i = index; i < s_active_event_count; i++)
   {
-    s_active_events_head = event->next;
-    if (s_active_events_head)
-      UpdateCPUDowncount();
+    s_active_events[i] = s_active_events[i + 1];
+    s_active_events[i]->m_active_index = i;
   }
 
-  event->prev = nullptr;
-  event->next = nullptr;
+  s_active_events[s_active_event_count] = nullptr;
+  event->m_active_index = 0;
 
-  s_active_event_count--;
+  if (index == 0 && s_active_event_count > 0)
+    UpdateCPUDowncount();
 }
 
 static void SortEvents()
 {
-  std::vector<TimingEvent*> events;
-  events.reserve(s_active_event_count);
-
-  TimingEvent* next = s_active_events_head;
-  while (next)
-  {
-    TimingEvent* current = next;
-    events.push_back(current);
-    next = current->next;
-    current->prev = nullptr;
-    current->next = nullptr;
-  }
+  const u32 count = s_active_event_count;
+  std::array<TimingEvent*, MAX_ACTIVE_EVENTS> events = s_active_events;
 
-  s_active_events_head = nullptr;
-  s_active_events_tail = nullptr;
+  s_active_events.fill(nullptr);
   s_active_event_count = 0;
 
-  for (TimingEvent* event : events)
-    AddActiveEvent(event);
+  for (u32 i = 0; i < count; i++)
+    AddActiveEvent(events[i]);
 }
 
-static TimingEvent* FindActiveEvent(const char* name)
+static TimingEvent* FindActiveEvent(const std::string& name)
 {
-  for (TimingEvent* event = s_active_events_head; event; event = event->next)
+  for (u32 i = 0; i < s_active_event_count; i++)
   {
-    if (event->GetName().compare(name) == 0)
-      return event;
+    if (s_active_events[i]->GetName() == name)
+      return s_active_events[i];
   }
 
   return nullptr;
@@ -279,29 +199,29 @@ void RunEvents()
       CPU::DispatchInterrupt();
 
     TickCount pending_ticks = CPU::GetPendingTicks();
-    if (pending_ticks >= s_active_events_head->GetDowncount())
+    if (pending_ticks >= s_active_events[0]->GetDowncount())
     {
       CPU::ResetPendingTicks();
 
       do
       {
-        const TickCount time = std::min(pending_ticks, s_active_events_head->GetDowncount());
+        const TickCount time = std::min(pending_ticks, s_active_events[0]->GetDowncount());
         s_global_tick_counter += static_cast<u32>(time);
         pending_ticks -= time;
 
         // Apply downcount to all events.
         // This will result in a negative downcount for those events which are late.
-        for (TimingEvent* event = s_active_events_head; event; event = event->next)
+        for (u32 i = 0; i < s_active_event_count; i++)
         {
+          TimingEvent* event = s_active_events[i];
           event->m_downcount -= time;
           event->m_time_since_last_run += time;
         }
 
         // Now we can actually run the callbacks.
-        while (s_active_events_head->m_downcount <= 0)
+        while (s_active_events[0]->m_downcount <= 0)
         {
-          // move it to the end, since that'll likely be its new position
-          TimingEvent* event = s_active_events_head;
+          TimingEvent* event = s_active_events[0];
           s_current_event = event;
 
           // Factor late time into the time for the next invocation.
@@ -353,7 +273,7 @@ bool DoState(StateWrapper& sw)
       if (sw.HasError())
         return false;
 
-      TimingEvent* event = FindActiveEvent(event_name.c_str());
+      TimingEvent* event = FindActiveEvent(event_name);
       if (!event)
       {
         Log_WarningPrintf("Save state has event '%s', but couldn't find this event when loading.", event_name.c_str());
@@ -381,8 +301,9 @@ bool DoState(StateWrapper& sw)
 
     sw.Do(&s_active_event_count);
 
-    for (TimingEvent* event = s_active_events_head; event; event = event->next)
+    for (u32 i = 0; i < s_active_event_count; i++)
     {
+      TimingEvent* event = s_active_events[i];
       sw.Do(&event->m_name);
       sw.Do(&event->m_downcount);
       sw.Do(&event->m_time_since_last_run);
@@ -433,7 +354,7 @@ void TimingEvent::Delay(TickCount ticks)
 
   DebugAssert(TimingEvents::s_current_event != this);
   TimingEvents::SortEvent(this);
-  if (TimingEvents::s_active_events_head == this)
+  if (TimingEvents::s_active_events[0] == this)
     TimingEvents::UpdateCPUDowncount();
 }
 
@@ -456,7 +377,7 @@ void TimingEvent::Schedule(TickCount ticks)
     if (TimingEvents::s_current_event != this)
     {
       TimingEvents::SortEvent(this);
-      if (TimingEvents::s_active_events_head == this)
+      if (TimingEvents::s_active_events[0] == this)
         TimingEvents::UpdateCPUDowncount();
     }
   }
@@ -485,7 +406,7 @@ void TimingEvent::Reset()
   if (TimingEvents::s_current_event != this)
   {
     TimingEvents::SortEvent(this);
-    if (TimingEvents::s_active_events_head == this)
+    if (TimingEvents::s_active_events[0] == this)
       TimingEvents::UpdateCPUDowncount();
   }
 }
@@ -507,7 +428,7 @@ void TimingEvent::InvokeEarly(bool force /* = false */)
   // Since we've changed the downcount, we need to re-sort the events.
   DebugAssert(TimingEvents::s_current_event != this);
   TimingEvents::SortEvent(this);
-  if (TimingEvents::s_active_events_head == this)
+  if (TimingEvents::s_active_events[0] == this)
     TimingEvents::UpdateCPUDowncount();
 }
 
@@ -63,8 +63,8 @@ public:
   void SetInterval(TickCount interval) { m_interval = interval; }
   void SetPeriod(TickCount period) { m_period = period; }
 
-  TimingEvent* prev = nullptr;
-  TimingEvent* next = nullptr;
+  // Position in the sorted active event array, only valid while active.
+  u32 m_active_index = 0;
 
   TimingEventCallback m_callback;
   void* m_callback_param;
@@ -301,6 +301,12 @@ void AdvancedSettingsWidget::addTweakOptions()
                         "RecompilerMemoryExceptions", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Linking"), "CPU",
                         "RecompilerBlockLinking", true);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Block Cache"), "CPU",
+                        "RecompilerBlockCache", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Background Compilation"), "CPU",
+                        "RecompilerAsyncCompile", false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Traces"), "CPU", "RecompilerTraces",
+                        false);
   addChoiceTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable Recompiler Fast Memory Access"), "CPU",
                        "FastmemMode", Settings::ParseCPUFastmemMode, Settings::GetCPUFastmemModeName,
                        Settings::GetCPUFastmemModeDisplayName, "CPUFastmemMode",
@@ -308,6 +314,7 @@ void AdvancedSettingsWidget::addTweakOptions()
 
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Use Old MDEC Routines"), "Hacks", "UseOldMDECRoutines",
                         false);
+  addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Use MDEC Thread"), "Hacks", "UseMDECThread", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Enable VRAM Write Texture Replacement"),
                         "TextureReplacements", "EnableVRAMWriteReplacements", false);
   addBooleanTweakOption(m_dialog, m_ui.tweakOptionTable, tr("Preload Texture Replacements"), "TextureReplacements",
@@ -369,8 +376,12 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
                              Settings::DEFAULT_GPU_PGXP_DEPTH_THRESHOLD); // PGXP depth clear threshold
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler memory exceptions
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, true);              // Recompiler block linking
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler block cache
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler background compilation
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);             // Recompiler traces
     setChoiceTweakOption(m_ui.tweakOptionTable, i++, Settings::DEFAULT_CPU_FASTMEM_MODE); // Recompiler fastmem mode
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                             // Use Old MDEC Routines
+    setBooleanTweakOption(m_ui.tweakOptionTable, i++, false);                             // Use MDEC Thread
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // VRAM write texture replacement
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // Preload texture replacements
     setBooleanTweakOption(m_ui.tweakOptionTable, i++, false); // Dump replacable VRAM writes
@@ -419,6 +430,9 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("GPU", "PGXPDepthClearThreshold");
   sif->DeleteValue("CPU", "RecompilerMemoryExceptions");
   sif->DeleteValue("CPU", "RecompilerBlockLinking");
+  sif->DeleteValue("CPU", "RecompilerBlockCache");
+  sif->DeleteValue("CPU", "RecompilerAsyncCompile");
+  sif->DeleteValue("CPU", "RecompilerTraces");
   sif->DeleteValue("CPU", "FastmemMode");
   sif->DeleteValue("TextureReplacements", "EnableVRAMWriteReplacements");
   sif->DeleteValue("TextureReplacements", "PreloadTextures");
@@ -427,6 +441,7 @@ void AdvancedSettingsWidget::onResetToDefaultClicked()
   sif->DeleteValue("TextureReplacements", "DumpVRAMWriteWidthThreshold");
   sif->DeleteValue("TextureReplacements", "DumpVRAMWriteHeightThreshold");
   sif->DeleteValue("Hacks", "UseOldMDECRoutines");
+  sif->DeleteValue("Hacks", "UseMDECThread");
   sif->DeleteValue("Hacks", "DMAMaxSliceTicks");
   sif->DeleteValue("Hacks", "DMAHaltTicks");
   sif->DeleteValue("Hacks", "GPUFIFOSize");
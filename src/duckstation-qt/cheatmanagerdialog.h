@@ -60,7 +60,7 @@ private Q_SLOTS:
 private:
   enum : int
   {
-    MAX_DISPLAYED_SCAN_RESULTS = 5000
+    MAX_DISPLAYED_SCAN_RESULTS = static_cast<int>(MemoryScan::MAX_VISIBLE_RESULTS)
   };
 
   void setupAdditionalUi();
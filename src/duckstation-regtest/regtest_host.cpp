@@ -8,15 +8,23 @@
 #include "common/memory_settings_interface.h"
 #include "common/path.h"
 #include "common/string_util.h"
+#include "common/threading.h"
+#include "common/timer.h"
 #include "core/common_host.h"
+#include "core/cpu_code_cache.h"
 #include "core/game_list.h"
+#include "core/gpu.h"
 #include "core/host.h"
 #include "core/host_settings.h"
+#include "core/mdec.h"
 #include "core/system.h"
 #include "scmversion/scmversion.h"
 #include "util/host_display.h"
 #include "util/imgui_manager.h"
 #include "util/input_manager.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include <algorithm>
 #include <csignal>
 #include <cstdio>
 Log_SetChannel(RegTestHost);
@@ -35,6 +43,10 @@ static void HookSignals();
 static void SetAppRoot();
 static bool SetFolders();
 static std::string GetFrameDumpFilename(u32 frame);
+static void UpdateBenchmark();
+static void FinishBenchmark();
+static bool WriteBenchmarkResults();
+static bool RunMDECBenchmark();
 } // namespace RegTestHost
 
 static std::unique_ptr<MemorySettingsInterface> s_base_settings_interface;
@@ -44,6 +56,19 @@ static u32 s_frame_dump_interval = 0;
 static std::string s_dump_base_directory;
 static std::string s_dump_game_directory;
 
+static std::string s_benchmark_output;
+static std::string s_benchmark_results;
+static std::vector<float> s_benchmark_frame_times;
+static Common::Timer::Value s_benchmark_start_time = 0;
+static Common::Timer::Value s_benchmark_last_frame_time = 0;
+static u64 s_benchmark_start_cpu_time = 0;
+static u64 s_benchmark_start_sw_time = 0;
+static u64 s_benchmark_start_sw_raster_time = 0;
+
+static std::string s_mdec_capture_path;
+static std::string s_mdec_benchmark_path;
+static bool s_mdec_verify = false;
+
 bool RegTestHost::SetFolders()
 {
   std::string program_path(FileSystem::GetProgramPath());
@@ -252,9 +277,17 @@ void Host::OnGameChanged(const std::string& disc_path, const std::string& game_s
 
 void Host::PumpMessagesOnCPUThread()
 {
+  if (!s_benchmark_output.empty())
+    RegTestHost::UpdateBenchmark();
+
   s_frames_to_run--;
   if (s_frames_to_run == 0)
+  {
+    if (!s_benchmark_output.empty())
+      RegTestHost::FinishBenchmark();
+
     System::ShutdownSystem(false);
+  }
 }
 
 void Host::RunOnCPUThread(std::function<void()> function, bool block /* = false */)
@@ -333,7 +366,10 @@ void Host::RenderDisplay(bool skip_present)
     g_host_display->WriteDisplayTextureToFile(std::move(dump_filename));
   }
 
-  g_host_display->Render(true);
+  // Presentation isn't part of what we're measuring when benchmarking.
+  if (s_benchmark_output.empty())
+    g_host_display->Render(true);
+
   ImGuiManager::NewFrame();
 }
 
@@ -450,6 +486,12 @@ void RegTestHost::PrintCommandLineHelp(const char* progname)
   std::fprintf(stderr, "  -frames: Sets the number of frames to execute.\n");
   std::fprintf(stderr, "  -log <level>: Sets the log level. Defaults to verbose.\n");
   std::fprintf(stderr, "  -renderer <renderer>: Sets the graphics renderer. Default to software.\n");
+  std::fprintf(stderr, "  -cpu <mode>: Sets the CPU execution mode (Interpreter, CachedInterpreter, Recompiler).\n");
+  std::fprintf(stderr, "  -benchmark <filename>: Disables presentation, and writes performance results as JSON\n"
+                       "    to the specified file, or stdout if the filename is -.\n");
+  std::fprintf(stderr, "  -mdeccapture <filename>: Writes all data sent to the MDEC to the specified file.\n");
+  std::fprintf(stderr, "  -mdecbench <filename>: Decodes a MDEC capture as fast as possible and exits.\n");
+  std::fprintf(stderr, "  -mdecverify: Checks the vectorized MDEC routines against the reference and exits.\n");
   std::fprintf(stderr, "  --: Signals that no more arguments will follow and the remaining\n"
                        "    parameters make up the filename. Use when the filename contains\n"
                        "    spaces or starts with a dash.\n");
@@ -542,6 +584,45 @@ bool RegTestHost::ParseCommandLineParameters(int argc, char* argv[], std::option
         s_base_settings_interface->SetStringValue("GPU", "Renderer", Settings::GetRendererName(renderer.value()));
         continue;
       }
+      else if (CHECK_ARG_PARAM("-cpu"))
+      {
+        std::optional<CPUExecutionMode> mode = Settings::ParseCPUExecutionMode(argv[++i]);
+        if (!mode.has_value())
+        {
+          Log_ErrorPrintf("Invalid CPU execution mode specified.");
+          return false;
+        }
+
+        s_base_settings_interface->SetStringValue("CPU", "ExecutionMode",
+                                                  Settings::GetCPUExecutionModeName(mode.value()));
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-benchmark"))
+      {
+        s_benchmark_output = argv[++i];
+        if (s_benchmark_output.empty())
+        {
+          Log_ErrorPrintf("Invalid benchmark output specified.");
+          return false;
+        }
+
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-mdeccapture"))
+      {
+        s_mdec_capture_path = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG_PARAM("-mdecbench"))
+      {
+        s_mdec_benchmark_path = argv[++i];
+        continue;
+      }
+      else if (CHECK_ARG("-mdecverify"))
+      {
+        s_mdec_verify = true;
+        continue;
+      }
       else if (CHECK_ARG("--"))
       {
         no_more_args = true;
@@ -570,6 +651,212 @@ std::string RegTestHost::GetFrameDumpFilename(u32 frame)
   return Path::Combine(s_dump_game_directory, fmt::format("frame_{:05d}.png", frame));
 }
 
+void RegTestHost::UpdateBenchmark()
+{
+  const Common::Timer::Value now = Common::Timer::GetCurrentValue();
+  if (s_benchmark_start_time == 0)
+  {
+    // Start measuring from the end of the first frame, so boot time isn't included.
+    const Threading::Thread* sw_thread = g_gpu->GetSWThread();
+    s_benchmark_start_time = now;
+    s_benchmark_start_cpu_time = Threading::ThreadHandle::GetForCallingThread().GetCPUTime();
+    s_benchmark_start_sw_time = sw_thread ? sw_thread->GetCPUTime() : 0;
+    s_benchmark_start_sw_raster_time = g_gpu->GetSWRasterThreadsCPUTime();
+    s_benchmark_frame_times.reserve(s_frames_to_run);
+  }
+  else
+  {
+    s_benchmark_frame_times.push_back(
+      static_cast<float>(Common::Timer::ConvertValueToMilliseconds(now - s_benchmark_last_frame_time)));
+  }
+
+  s_benchmark_last_frame_time = now;
+}
+
+void RegTestHost::FinishBenchmark()
+{
+  const Threading::Thread* sw_thread = g_gpu->GetSWThread();
+  const u64 cpu_time = Threading::ThreadHandle::GetForCallingThread().GetCPUTime() - s_benchmark_start_cpu_time;
+  const u64 sw_time = sw_thread ? (sw_thread->GetCPUTime() - s_benchmark_start_sw_time) : 0;
+  // Raster threads are recreated when the thread count changes, only count the new ones if that happens.
+  const u64 sw_raster_end_time = g_gpu->GetSWRasterThreadsCPUTime();
+  const u64 sw_raster_time = (sw_raster_end_time >= s_benchmark_start_sw_raster_time) ?
+                               (sw_raster_end_time - s_benchmark_start_sw_raster_time) :
+                               sw_raster_end_time;
+  const double thread_ticks_per_second = static_cast<double>(Threading::GetThreadTicksPerSecond());
+  const double wall_time = Common::Timer::ConvertValueToSeconds(s_benchmark_last_frame_time - s_benchmark_start_time);
+  const double cpu_thread_time = static_cast<double>(cpu_time) / thread_ticks_per_second;
+  const double sw_thread_time = static_cast<double>(sw_time) / thread_ticks_per_second;
+  const double sw_raster_thread_time = static_cast<double>(sw_raster_time) / thread_ticks_per_second;
+  const u32 frames = static_cast<u32>(s_benchmark_frame_times.size());
+  const double emulated_fps = System::GetThrottleFrequency();
+  const double wall_fps = (wall_time > 0.0) ? (static_cast<double>(frames) / wall_time) : 0.0;
+
+  std::vector<float> sorted_frame_times(s_benchmark_frame_times);
+  std::sort(sorted_frame_times.begin(), sorted_frame_times.end());
+  const auto percentile = [&sorted_frame_times](double pct) {
+    if (sorted_frame_times.empty())
+      return 0.0;
+
+    const size_t index = static_cast<size_t>(pct / 100.0 * static_cast<double>(sorted_frame_times.size() - 1) + 0.5);
+    return static_cast<double>(sorted_frame_times[index]);
+  };
+  double frame_time_sum = 0.0;
+  for (const float time : sorted_frame_times)
+    frame_time_sum += time;
+
+  const CPU::CodeCache::Statistics& cc_stats = CPU::CodeCache::GetStatistics();
+
+  rapidjson::StringBuffer buffer;
+  rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+
+  writer.Key("version");
+  writer.String(g_scm_tag_str);
+  writer.Key("path");
+  writer.String(System::GetDiscPath().c_str());
+  writer.Key("serial");
+  writer.String(System::GetGameSerial().c_str());
+  writer.Key("title");
+  writer.String(System::GetGameTitle().c_str());
+  writer.Key("renderer");
+  writer.String(Settings::GetRendererName(g_settings.gpu_renderer));
+  writer.Key("cpu_execution_mode");
+  writer.String(Settings::GetCPUExecutionModeName(g_settings.cpu_execution_mode));
+
+  writer.Key("frames");
+  writer.Uint(frames);
+  writer.Key("wall_time");
+  writer.Double(wall_time);
+  writer.Key("emulated_time");
+  writer.Double(static_cast<double>(frames) / emulated_fps);
+  writer.Key("emulated_fps");
+  writer.Double(emulated_fps);
+  writer.Key("wall_fps");
+  writer.Double(wall_fps);
+  writer.Key("speed");
+  writer.Double(wall_fps / emulated_fps * 100.0);
+
+  writer.Key("frame_time_ms");
+  writer.StartObject();
+  writer.Key("min");
+  writer.Double(sorted_frame_times.empty() ? 0.0 : sorted_frame_times.front());
+  writer.Key("mean");
+  writer.Double(frames > 0 ? (frame_time_sum / static_cast<double>(frames)) : 0.0);
+  writer.Key("p50");
+  writer.Double(percentile(50.0));
+  writer.Key("p90");
+  writer.Double(percentile(90.0));
+  writer.Key("p95");
+  writer.Double(percentile(95.0));
+  writer.Key("p99");
+  writer.Double(percentile(99.0));
+  writer.Key("max");
+  writer.Double(sorted_frame_times.empty() ? 0.0 : sorted_frame_times.back());
+  writer.EndObject();
+
+  writer.Key("threads");
+  writer.StartObject();
+  writer.Key("cpu_time");
+  writer.Double(cpu_thread_time);
+  writer.Key("cpu_usage");
+  writer.Double((wall_time > 0.0) ? (cpu_thread_time / wall_time * 100.0) : 0.0);
+  writer.Key("sw_time");
+  writer.Double(sw_thread_time);
+  writer.Key("sw_usage");
+  writer.Double((wall_time > 0.0) ? (sw_thread_time / wall_time * 100.0) : 0.0);
+  writer.Key("sw_raster_time");
+  writer.Double(sw_raster_thread_time);
+  writer.Key("sw_raster_usage");
+  writer.Double((wall_time > 0.0) ? (sw_raster_thread_time / wall_time * 100.0) : 0.0);
+  writer.Key("gpu_time");
+  writer.Double(sw_thread_time + sw_raster_thread_time);
+  writer.EndObject();
+
+  writer.Key("code_cache");
+  writer.StartObject();
+  writer.Key("blocks_compiled");
+  writer.Uint(cc_stats.blocks_compiled);
+  writer.Key("blocks_recompiled");
+  writer.Uint(cc_stats.blocks_recompiled);
+  writer.Key("blocks_invalidated");
+  writer.Uint(cc_stats.blocks_invalidated);
+  writer.Key("interpreter_fallbacks");
+  writer.Uint(cc_stats.interpreter_fallbacks);
+  writer.Key("flushes");
+  writer.Uint(cc_stats.flushes);
+  writer.Key("traces_compiled");
+  writer.Uint(cc_stats.traces_compiled);
+  writer.EndObject();
+
+  writer.EndObject();
+
+  s_benchmark_results.assign(buffer.GetString(), buffer.GetSize());
+}
+
+bool RegTestHost::WriteBenchmarkResults()
+{
+  if (s_benchmark_results.empty())
+  {
+    Log_ErrorPrint("No benchmark results were collected.");
+    return false;
+  }
+
+  if (s_benchmark_output == "-")
+  {
+    std::fprintf(stdout, "%s\n", s_benchmark_results.c_str());
+    std::fflush(stdout);
+    return true;
+  }
+
+  if (!FileSystem::WriteStringToFile(s_benchmark_output.c_str(), s_benchmark_results))
+  {
+    Log_ErrorPrintf("Failed to write benchmark results to '%s'.", s_benchmark_output.c_str());
+    return false;
+  }
+
+  Log_InfoPrintf("Wrote benchmark results to '%s'.", s_benchmark_output.c_str());
+  return true;
+}
+
+bool RegTestHost::RunMDECBenchmark()
+{
+  // Speed doesn't matter if the output is wrong.
+  if (!MDEC::VerifyKernels())
+  {
+    Log_ErrorPrint("MDEC routines do not match the reference.");
+    return false;
+  }
+
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(s_mdec_benchmark_path.c_str());
+  if (!data.has_value() || data->size() < sizeof(u32))
+  {
+    Log_ErrorPrintf("Failed to read MDEC capture '%s'.", s_mdec_benchmark_path.c_str());
+    return false;
+  }
+
+  std::vector<u32> words(data->size() / sizeof(u32));
+  std::memcpy(words.data(), data->data(), words.size() * sizeof(u32));
+
+  // Run the capture repeatedly for a couple of seconds, to even out any noise.
+  static constexpr double MIN_BENCHMARK_TIME = 2.0;
+  u64 blocks_decoded = 0;
+  u32 iterations = 0;
+  Common::Timer timer;
+  do
+  {
+    blocks_decoded += MDEC::DecodeCapture(words.data(), static_cast<u32>(words.size()));
+    iterations++;
+  } while (timer.GetTimeSeconds() < MIN_BENCHMARK_TIME);
+
+  const double elapsed = timer.GetTimeSeconds();
+  Log_InfoPrintf("Decoded %" PRIu64 " blocks in %u iterations over %.2f seconds.", blocks_decoded, iterations,
+                 elapsed);
+  Log_InfoPrintf("%.2f blocks/sec, %.3f ms per iteration.", static_cast<double>(blocks_decoded) / elapsed,
+                 (elapsed * 1000.0) / static_cast<double>(iterations));
+  return (blocks_decoded > 0);
+}
+
 int main(int argc, char* argv[])
 {
   RegTestHost::InitializeEarlyConsole();
@@ -581,6 +868,16 @@ int main(int argc, char* argv[])
   if (!RegTestHost::ParseCommandLineParameters(argc, argv, autoboot))
     return EXIT_FAILURE;
 
+  if (s_mdec_verify)
+  {
+    const bool result = MDEC::VerifyKernels();
+    Log_InfoPrintf("MDEC verification %s.", result ? "passed" : "failed");
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  if (!s_mdec_benchmark_path.empty())
+    return RegTestHost::RunMDECBenchmark() ? EXIT_SUCCESS : EXIT_FAILURE;
+
   if (!autoboot || autoboot->filename.empty())
   {
     Log_ErrorPrintf("No boot path specified.");
@@ -608,8 +905,15 @@ int main(int argc, char* argv[])
     Log_InfoPrintf("Dumping every %dth frame to '%s'.", s_frame_dump_interval, s_dump_base_directory.c_str());
   }
 
+  if (!s_mdec_capture_path.empty() && !MDEC::StartCapture(s_mdec_capture_path.c_str()))
+    goto cleanup;
+
   Log_InfoPrintf("Running for %d frames...", s_frames_to_run);
   System::Execute();
+  MDEC::StopCapture();
+
+  if (!s_benchmark_output.empty() && !RegTestHost::WriteBenchmarkResults())
+    goto cleanup;
 
   Log_InfoPrintf("Exiting with success.");
   result = 0;
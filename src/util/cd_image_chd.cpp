@@ -16,17 +16,21 @@
 #include "common/path.h"
 #include "common/platform.h"
 #include "common/string_util.h"
+#include "common/threading.h"
 
 #include "fmt/format.h"
 #include "libchdr/chd.h"
 
 #include <algorithm>
 #include <cerrno>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <optional>
+#include <thread>
 
 Log_SetChannel(CDImageCHD);
 
@@ -74,20 +78,62 @@ private:
   {
     CHD_CD_SECTOR_DATA_SIZE = 2352 + 96,
     CHD_CD_TRACK_ALIGNMENT = 4,
-    MAX_PARENTS = 32 // Surely someone wouldn't be insane enough to go beyond this...
+    MAX_PARENTS = 32, // Surely someone wouldn't be insane enough to go beyond this...
+
+    HUNK_CACHE_SIZE = 16,
+    PREFETCH_HUNK_COUNT = 8,
+    SEQUENTIAL_HUNKS_BEFORE_PREFETCH = 2,
+    INVALID_HUNK_INDEX = 0xFFFFFFFFu,
+  };
+
+  enum class HunkState : u8
+  {
+    Empty,
+    Loading,
+    Ready
+  };
+
+  struct CachedHunk
+  {
+    u32 hunk_index = INVALID_HUNK_INDEX;
+    HunkState state = HunkState::Empty;
+    u64 last_used = 0;
   };
 
   chd_file* OpenCHD(const char* filename, FileSystem::ManagedCFilePtr fp, Error* error, u32 recursion_level);
-  bool ReadHunk(u32 hunk_index);
+
+  u8* GetHunkCacheData(u32 slot) { return &m_hunk_cache_data[slot * m_hunk_size]; }
+  std::optional<u32> FindCachedHunk(u32 hunk_index) const;
+  std::optional<u32> AllocateCachedHunk(u32 hunk_index);
+  bool ReadHunk(u32 hunk_index, u32 slot);
+  void UpdatePrefetch(u32 hunk_index);
+  void StartPrefetchThread();
+  void StopPrefetchThread();
+  void PrefetchThreadEntryPoint();
 
   chd_file* m_chd = nullptr;
   u32 m_hunk_size = 0;
   u32 m_sectors_per_hunk = 0;
-
-  std::vector<u8> m_hunk_buffer;
-  u32 m_current_hunk_index = static_cast<u32>(-1);
   bool m_precached = false;
 
+  // Decompressed hunks, shared between the reading thread and the prefetch thread. The slot metadata is protected by
+  // m_hunk_cache_mutex, chd_read() is not thread safe so the CHD itself is protected by m_chd_mutex.
+  std::mutex m_hunk_cache_mutex;
+  std::mutex m_chd_mutex;
+  std::condition_variable m_hunk_loaded_cv;
+  std::vector<u8> m_hunk_cache_data;
+  std::array<CachedHunk, HUNK_CACHE_SIZE> m_hunk_cache;
+  u64 m_hunk_cache_counter = 0;
+
+  // Sequential access detection, the prefetch thread decompresses [m_prefetch_next, m_prefetch_end) ahead of the reader.
+  u32 m_last_hunk_index = INVALID_HUNK_INDEX;
+  u32 m_sequential_hunk_count = 0;
+  u32 m_prefetch_next = 0;
+  u32 m_prefetch_end = 0;
+  std::thread m_prefetch_thread;
+  std::condition_variable m_prefetch_cv;
+  bool m_prefetch_shutdown = false;
+
   CDSubChannelReplacement m_sbi;
 };
 } // namespace
@@ -96,6 +142,8 @@ CDImageCHD::CDImageCHD() = default;
 
 CDImageCHD::~CDImageCHD()
 {
+  StopPrefetchThread();
+
   if (m_chd)
     chd_close(m_chd);
 }
@@ -213,7 +261,7 @@ bool CDImageCHD::Open(const char* filename, Error* error)
   }
 
   m_sectors_per_hunk = m_hunk_size / CHD_CD_SECTOR_DATA_SIZE;
-  m_hunk_buffer.resize(m_hunk_size);
+  m_hunk_cache_data.resize(m_hunk_size * HUNK_CACHE_SIZE);
   m_filename = filename;
 
   u32 disc_lba = 0;
@@ -391,6 +439,7 @@ CDImage::PrecacheResult CDImageCHD::Precache(ProgressCallback* progress)
     static_cast<ProgressCallback*>(param)->SetProgressValue(std::min<u32>(percent, 100));
   };
 
+  std::unique_lock<std::mutex> lock(m_chd_mutex);
   if (chd_precache_progress(m_chd, callback, progress) != CHDERR_NONE)
     return CDImage::PrecacheResult::ReadError;
 
@@ -450,34 +499,188 @@ bool CDImageCHD::ReadSectorFromIndex(void* buffer, const Index& index, LBA lba_i
   const u32 hunk_offset = static_cast<u32>((disc_frame % m_sectors_per_hunk) * CHD_CD_SECTOR_DATA_SIZE);
   DebugAssert((m_hunk_size - hunk_offset) >= CHD_CD_SECTOR_DATA_SIZE);
 
-  if (m_current_hunk_index != hunk_index && !ReadHunk(hunk_index))
-    return false;
+  std::unique_lock<std::mutex> lock(m_hunk_cache_mutex);
+  if (hunk_index != m_last_hunk_index)
+    UpdatePrefetch(hunk_index);
+
+  std::optional<u32> slot = FindCachedHunk(hunk_index);
+  if (slot.has_value() && m_hunk_cache[slot.value()].state == HunkState::Loading)
+  {
+    // Prefetch thread is already decompressing it, no point doing it twice.
+    const CachedHunk& hunk = m_hunk_cache[slot.value()];
+    m_hunk_loaded_cv.wait(lock, [&hunk, hunk_index]() {
+      return (hunk.state != HunkState::Loading || hunk.hunk_index != hunk_index);
+    });
+    if (hunk.state != HunkState::Ready || hunk.hunk_index != hunk_index)
+      slot.reset();
+  }
+  if (!slot.has_value())
+  {
+    slot = AllocateCachedHunk(hunk_index);
+    if (!slot.has_value())
+      return false;
+
+    lock.unlock();
+    const bool result = ReadHunk(hunk_index, slot.value());
+    lock.lock();
+    m_hunk_loaded_cv.notify_all();
+    if (!result)
+      return false;
+  }
+
+  CachedHunk& hunk = m_hunk_cache[slot.value()];
+  hunk.last_used = ++m_hunk_cache_counter;
 
   // Audio data is in big-endian, so we have to swap it for little endian hosts...
+  const u8* hunk_data = GetHunkCacheData(slot.value());
   if (index.mode == TrackMode::Audio)
-    CopyAndSwap(buffer, &m_hunk_buffer[hunk_offset], RAW_SECTOR_SIZE);
+    CopyAndSwap(buffer, &hunk_data[hunk_offset], RAW_SECTOR_SIZE);
   else
-    std::memcpy(buffer, &m_hunk_buffer[hunk_offset], RAW_SECTOR_SIZE);
+    std::memcpy(buffer, &hunk_data[hunk_offset], RAW_SECTOR_SIZE);
 
   return true;
 }
 
-bool CDImageCHD::ReadHunk(u32 hunk_index)
+std::optional<u32> CDImageCHD::FindCachedHunk(u32 hunk_index) const
+{
+  for (u32 i = 0; i < HUNK_CACHE_SIZE; i++)
+  {
+    if (m_hunk_cache[i].hunk_index == hunk_index && m_hunk_cache[i].state != HunkState::Empty)
+      return i;
+  }
+
+  return std::nullopt;
+}
+
+std::optional<u32> CDImageCHD::AllocateCachedHunk(u32 hunk_index)
 {
-  const chd_error err = chd_read(m_chd, hunk_index, m_hunk_buffer.data());
+  // Evict the least recently used hunk, skipping any which are still being decompressed.
+  std::optional<u32> slot;
+  for (u32 i = 0; i < HUNK_CACHE_SIZE; i++)
+  {
+    const CachedHunk& hunk = m_hunk_cache[i];
+    if (hunk.state == HunkState::Loading)
+      continue;
+    if (hunk.state == HunkState::Empty)
+    {
+      slot = i;
+      break;
+    }
+    if (!slot.has_value() || hunk.last_used < m_hunk_cache[slot.value()].last_used)
+      slot = i;
+  }
+
+  if (!slot.has_value())
+  {
+    Log_ErrorPrintf("No free hunk cache slots for hunk %u", hunk_index);
+    return std::nullopt;
+  }
+
+  CachedHunk& hunk = m_hunk_cache[slot.value()];
+  hunk.hunk_index = hunk_index;
+  hunk.state = HunkState::Loading;
+  hunk.last_used = ++m_hunk_cache_counter;
+  return slot;
+}
+
+bool CDImageCHD::ReadHunk(u32 hunk_index, u32 slot)
+{
+  chd_error err;
+  {
+    std::unique_lock<std::mutex> lock(m_chd_mutex);
+    err = chd_read(m_chd, hunk_index, GetHunkCacheData(slot));
+  }
+
+  std::unique_lock<std::mutex> lock(m_hunk_cache_mutex);
+  CachedHunk& hunk = m_hunk_cache[slot];
   if (err != CHDERR_NONE)
   {
     Log_ErrorPrintf("chd_read(%u) failed: %s", hunk_index, chd_error_string(err));
 
     // data might have been partially written
-    m_current_hunk_index = static_cast<u32>(-1);
+    hunk.hunk_index = INVALID_HUNK_INDEX;
+    hunk.state = HunkState::Empty;
     return false;
   }
 
-  m_current_hunk_index = hunk_index;
+  hunk.state = HunkState::Ready;
   return true;
 }
 
+void CDImageCHD::UpdatePrefetch(u32 hunk_index)
+{
+  // Only bother prefetching for streaming reads (FMVs, XA/CDDA audio), random access would just waste time.
+  if (m_last_hunk_index != INVALID_HUNK_INDEX && hunk_index == (m_last_hunk_index + 1))
+    m_sequential_hunk_count++;
+  else
+    m_sequential_hunk_count = 0;
+  m_last_hunk_index = hunk_index;
+
+  const u32 hunk_count = m_chd ? chd_get_header(m_chd)->totalhunks : 0;
+  if (m_sequential_hunk_count < SEQUENTIAL_HUNKS_BEFORE_PREFETCH)
+  {
+    // Drop anything queued from the previous stream.
+    m_prefetch_next = m_prefetch_end = 0;
+    return;
+  }
+
+  m_prefetch_next = std::max(m_prefetch_next, hunk_index + 1);
+  m_prefetch_end = std::min(hunk_index + 1 + PREFETCH_HUNK_COUNT, hunk_count);
+  if (m_prefetch_next >= m_prefetch_end)
+    return;
+
+  if (!m_prefetch_thread.joinable())
+    StartPrefetchThread();
+  else
+    m_prefetch_cv.notify_one();
+}
+
+void CDImageCHD::StartPrefetchThread()
+{
+  m_prefetch_shutdown = false;
+  m_prefetch_thread = std::thread(&CDImageCHD::PrefetchThreadEntryPoint, this);
+}
+
+void CDImageCHD::StopPrefetchThread()
+{
+  if (!m_prefetch_thread.joinable())
+    return;
+
+  {
+    std::unique_lock<std::mutex> lock(m_hunk_cache_mutex);
+    m_prefetch_shutdown = true;
+    m_prefetch_cv.notify_one();
+  }
+
+  m_prefetch_thread.join();
+}
+
+void CDImageCHD::PrefetchThreadEntryPoint()
+{
+  Threading::SetNameOfCurrentThread("CHD Prefetch");
+
+  std::unique_lock<std::mutex> lock(m_hunk_cache_mutex);
+  for (;;)
+  {
+    m_prefetch_cv.wait(lock, [this]() { return m_prefetch_shutdown || m_prefetch_next < m_prefetch_end; });
+    if (m_prefetch_shutdown)
+      break;
+
+    const u32 hunk_index = m_prefetch_next++;
+    if (FindCachedHunk(hunk_index).has_value())
+      continue;
+
+    const std::optional<u32> slot = AllocateCachedHunk(hunk_index);
+    if (!slot.has_value())
+      continue;
+
+    lock.unlock();
+    ReadHunk(hunk_index, slot.value());
+    lock.lock();
+    m_hunk_loaded_cv.notify_all();
+  }
+}
+
 std::unique_ptr<CDImage> CDImage::OpenCHDImage(const char* filename, Error* error)
 {
   std::unique_ptr<CDImageCHD> image = std::make_unique<CDImageCHD>();
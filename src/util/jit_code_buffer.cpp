@@ -167,7 +167,7 @@ void JitCodeBuffer::Destroy()
       Log_ErrorPrintf("Failed to free code pointer %p", m_code_ptr);
 #endif
   }
-  else if (m_code_ptr)
+  else if (m_code_ptr && m_total_size > 0)
   {
 #if defined(_WIN32)
     DWORD old_protect = 0;
@@ -204,6 +204,30 @@ void JitCodeBuffer::ReserveCode(u32 size)
   m_code_size -= size;
 }
 
+bool JitCodeBuffer::Split(JitCodeBuffer* other, u32 size, u32 far_code_size)
+{
+  if (size > GetFreeCodeSpace() || far_code_size > GetFreeFarCodeSpace())
+    return false;
+
+  other->Destroy();
+
+  other->m_code_ptr = m_free_code_ptr;
+  other->m_free_code_ptr = m_free_code_ptr;
+  other->m_code_size = size;
+  m_free_code_ptr += size;
+  m_code_used += size;
+
+  other->m_far_code_ptr = m_free_far_code_ptr;
+  other->m_free_far_code_ptr = m_free_far_code_ptr;
+  other->m_far_code_size = far_code_size;
+  m_free_far_code_ptr += far_code_size;
+  m_far_code_used += far_code_size;
+
+  // Total size of zero means there's no protection to restore on destroy, the owner does that.
+  other->m_total_size = 0;
+  return true;
+}
+
 void JitCodeBuffer::CommitCode(u32 length)
 {
   if (length == 0)
@@ -40,6 +40,10 @@ public:
   ALWAYS_INLINE u32 GetFreeFarCodeSpace() const { return static_cast<u32>(m_far_code_size - m_far_code_used); }
   void CommitFarCode(u32 length);
 
+  /// Hands the next size bytes of free near and far code space to another buffer, which does not own its memory. The
+  /// space counts as used here until the next Reset(). Code in either buffer can branch to the other.
+  bool Split(JitCodeBuffer* other, u32 size, u32 far_code_size);
+
   /// Adjusts the free code pointer to the specified alignment, padding with bytes.
   /// Assumes alignment is a power-of-two.
   void Align(u32 alignment, u8 padding_value);